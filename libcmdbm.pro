@@ -78,10 +78,16 @@ LIBS += -L$$DESTDIR -lcmutils
 
 SOURCES += \
     src/base.c \
+    src/columnar.c \
     src/connection.c \
     src/context.c \
     src/database.c \
+    src/export.c \
     src/mapper.c \
+    src/parallel.c \
+    src/pool.c \
+    src/prefetch.c \
+    src/resultset.c \
     src/session.c \
     src/sqlbuild.c \
     modules/cmdbm_mysql.c \
@@ -23,9 +23,13 @@ typedef struct CMDBM_MySQLCtx {
 	CMUTIL_String	*dbcs;
 } CMDBM_MySQLCtx;
 
+// default rows per round trip for server side cursors.
+#define CMDBM_MYSQL_PREFETCH_ROWS	100
+
 typedef struct CMDBM_MySQLSession {
 	CMDBM_MySQLCtx	*ctx;
 	MYSQL			*conn;
+	unsigned long	fetchsize;
 } CMDBM_MySQLSession;
 
 CMDBM_STATIC const char *CMDBM_MySQL_GetDBMSKey()
@@ -144,6 +148,16 @@ CMDBM_STATIC void CMDBM_MySQL_CloseConnection(
 	CMUTIL_UNUSED(initres);
 }
 
+CMDBM_STATIC CMBool CMDBM_MySQL_PingConnection(
+		void *initres, void *connection)
+{
+	CMDBM_MySQLSession *sess = (CMDBM_MySQLSession*)connection;
+	CMUTIL_UNUSED(initres);
+	if (sess == NULL || sess->conn == NULL)
+		return CMFalse;
+	return mysql_ping(sess->conn) == 0? CMTrue:CMFalse;
+}
+
 CMDBM_STATIC CMBool CMDBM_MySQL_StartTransaction(
 		void *initres, void *connection)
 {
@@ -153,12 +167,8 @@ CMDBM_STATIC CMBool CMDBM_MySQL_StartTransaction(
         return CMFalse;
 	}
 	CMUTIL_UNUSED(initres);
-	if (mysql_query(sess->conn, "SET autocommit=0")) {
-		MYSQL_LOGERROR(sess,
-					   "current MySQL database does not support transaction.");
-        return CMFalse;
-	}
-	if (mysql_query(sess->conn, "START TRANSACTION")) {
+	// next statement starts transaction implicitly.
+	if (mysql_autocommit(sess->conn, 0)) {
 		MYSQL_LOGERROR(sess,
 					   "current MySQL database does not support transaction.");
         return CMFalse;
@@ -166,18 +176,6 @@ CMDBM_STATIC CMBool CMDBM_MySQL_StartTransaction(
     return CMTrue;
 }
 
-CMDBM_STATIC void CMDBM_MySQL_EndTransaction(
-		void *initres, void *connection)
-{
-	CMDBM_MySQLSession *sess = (CMDBM_MySQLSession*)connection;
-	if (sess == NULL || sess->conn == NULL) {
-		CMLogError("Invalid parameter.");
-		return;
-	}
-	mysql_query(sess->conn, "SET autocommit=1");
-	CMUTIL_UNUSED(initres);
-}
-
 CMDBM_STATIC CMBool CMDBM_MySQL_CommitTransaction(
 		void *initres, void *connection)
 {
@@ -187,7 +185,7 @@ CMDBM_STATIC CMBool CMDBM_MySQL_CommitTransaction(
 		return CMFalse;
 	}
 	CMUTIL_UNUSED(initres);
-	if (mysql_query(sess->conn, "COMMIT"))
+	if (mysql_commit(sess->conn) == 0)
         return CMTrue;
 	else
 		MYSQL_LOGERROR(sess, "commit failed.");
@@ -202,11 +200,25 @@ CMDBM_STATIC void CMDBM_MySQL_RollbackTransaction(
 		CMLogError("Invalid parameter.");
 		return;
 	}
-	if (mysql_query(sess->conn, "ROLLBACK"))
+	if (mysql_rollback(sess->conn))
 		MYSQL_LOGERROR(sess, "rollback failed.");
 	CMUTIL_UNUSED(initres);
 }
 
+CMDBM_STATIC void CMDBM_MySQL_EndTransaction(
+		void *initres, void *connection)
+{
+	CMDBM_MySQLSession *sess = (CMDBM_MySQLSession*)connection;
+	if (sess == NULL || sess->conn == NULL) {
+		CMLogError("Invalid parameter.");
+		return;
+	}
+	// enabling autocommit would commit uncommitted work, roll it back.
+	CMDBM_MySQL_RollbackTransaction(initres, connection);
+	if (mysql_autocommit(sess->conn, 1))
+		MYSQL_LOGERROR(sess, "cannot restore autocommit mode.");
+}
+
 CMDBM_STATIC void CMDBM_MySQL_BindLong(
 		MYSQL_BIND *bind, CMUTIL_JsonValue *jval,
 		CMUTIL_Array *bufarr, CMUTIL_Json *out)
@@ -305,9 +317,40 @@ CMDBM_STATIC void CMDBM_MySQL_SetOutValue(
 	}
 }
 
+CMDBM_STATIC CMBool CMDBM_MySQL_SendLobs(
+		CMDBM_MySQLSession *sess, MYSQL_STMT *stmt,
+		CMDBM_LobSource **lobs, size_t bsize)
+{
+	uint32_t i;
+	CMBool succ = CMFalse;
+	char *chunk = CMAlloc(CMDBM_LOB_CHUNK);
+	for (i=0; i<bsize; i++) {
+		int64_t n;
+		if (!lobs[i])
+			continue;
+		while ((n = lobs[i]->read(
+					chunk, CMDBM_LOB_CHUNK, lobs[i]->udata)) > 0) {
+			if (mysql_stmt_send_long_data(
+						stmt, i, chunk, (unsigned long)n) != 0) {
+				MYSQL_LOGERROR(sess, "sending long data failed.");
+				goto FAILEDPOINT;
+			}
+		}
+		if (n < 0) {
+			CMLogError("reading lob source '%s' failed.", lobs[i]->name);
+			goto FAILEDPOINT;
+		}
+	}
+	succ = CMTrue;
+FAILEDPOINT:
+	CMFree(chunk);
+	return succ;
+}
+
 CMDBM_STATIC MYSQL_STMT *CMDBM_MySQL_ExecuteBase(
 		CMDBM_MySQLSession *sess, CMUTIL_String *query,
-		CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
+		CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs,
+		unsigned long prefetch, CMDBM_LobSource **lobs)
 {
     uint32_t i;
     size_t bsize = 0;
@@ -334,6 +377,12 @@ CMDBM_STATIC MYSQL_STMT *CMDBM_MySQL_ExecuteBase(
 		char ibuf[20];
         CMUTIL_Json *json = CMCall(binds, Get, i);
 		sprintf(ibuf, "%d", i);
+		if (lobs && lobs[i]) {
+			// data is sent in chunks after binding.
+			buffers[i].buffer_type = lobs[i]->binary?
+						MYSQL_TYPE_BLOB:MYSQL_TYPE_STRING;
+			continue;
+		}
         if (CMCall(json, GetType) == CMJsonTypeValue) {
 			CMUTIL_JsonValue *jval = (CMUTIL_JsonValue*)json;
             CMUTIL_Json *out = CMCall(outs, Get, ibuf);
@@ -351,6 +400,20 @@ CMDBM_STATIC MYSQL_STMT *CMDBM_MySQL_ExecuteBase(
 			MYSQL_LOGERROR(sess, "variable binding failed.");
 			goto FAILEDPOINT;
 		}
+		if (lobs && !CMDBM_MySQL_SendLobs(sess, stmt, lobs, bsize))
+			goto FAILEDPOINT;
+	}
+
+	// read only server side cursor, rows are fetched 'prefetch' at a time
+	// instead of buffering whole result set in client.
+	if (prefetch > 0) {
+		unsigned long ctype = (unsigned long)CURSOR_TYPE_READ_ONLY;
+		if (mysql_stmt_attr_set(stmt, STMT_ATTR_CURSOR_TYPE, &ctype) ||
+				mysql_stmt_attr_set(
+					stmt, STMT_ATTR_PREFETCH_ROWS, &prefetch)) {
+			MYSQL_LOGERROR(sess, "cannot open cursor.");
+			goto FAILEDPOINT;
+		}
 	}
 
 	if (mysql_stmt_execute(stmt) == 0) {
@@ -388,12 +451,21 @@ struct CMDBM_MySQL_FieldInfo {
     MYSQL_BIND *bind;
     CMDBM_MySQLSession *sess;
     void (*fassign)(CMDBM_MySQL_FieldInfo*, MYSQL_STMT*, CMUTIL_JsonObject*);
+    char *strbuf;   // reused across rows, grows as needed
+    size_t strcap;
+    MYSQL_TIME timeVal;
+    unsigned long lobpos;   // read offset of lob reader
+    char numbuf[72];    // decimal text, 65 digits with sign and point
+    char textbuf[CMDBM_DATETIME_BUFSZ];
     int index;
+    int scale;
     CMJsonValueType jtype;
+    CMDBM_ValueKind kind;
     unsigned long length;
     my_bool isnull;
     my_bool error;
-    char    dummy_padder[6];
+    my_bool isdate;     // DATE column, text has no time part
+    char    dummy_padder[5];
 };
 
 CMDBM_STATIC void CMDBM_MySQL_ResultAssignLong(
@@ -410,33 +482,76 @@ CMDBM_STATIC void CMDBM_MySQL_ResultAssignDouble(
     CMCall(row, PutDouble, finfo->name, finfo->doubleVal);
 }
 
-CMDBM_STATIC void CMDBM_MySQL_ResultAssignString(
-		CMDBM_MySQL_FieldInfo *finfo, MYSQL_STMT *stmt, CMUTIL_JsonObject *row)
+CMDBM_STATIC const char *CMDBM_MySQL_FetchString(
+		CMDBM_MySQL_FieldInfo *finfo, MYSQL_STMT *stmt)
 {
     MYSQL_BIND *bind = finfo->bind;
+    finfo->strbuf = (char*)CMDBM_BufferGrow(
+                finfo->strbuf, &finfo->strcap, finfo->length+1, 0);
 	if (finfo->length > 0) {
         int ival;
-        char *buffer = CMAlloc(finfo->length*2+1);
-        bind->buffer = buffer;
-        bind->buffer_length = finfo->length*2;
-        memset(buffer, 0x0, finfo->length*2+1);
+        bind->buffer = finfo->strbuf;
+        bind->buffer_length = finfo->length;
         ival = mysql_stmt_fetch_column(
                     stmt, finfo->bind, (uint32_t)finfo->index, 0);
         if (ival != 0) {
             MYSQL_LOGERROR(finfo->sess, "mysql_stmt_fetch_column() failed.");
-        } else {
-            CMCall(row, PutString, finfo->name, buffer);
+            return NULL;
         }
-        // reset buffer
-        CMFree(buffer);
-        bind->buffer = NULL;
-        bind->buffer_length = 0;
-//		CMCall(row, PutString, finfo->name, (char*)bind->buffer);
-//		memset(bind->buffer, 0x0, 4096);
-	} else {
-        CMCall(row, PutNull, finfo->name);
 	}
+    // zero length is not null but empty
+    finfo->strbuf[finfo->length] = 0x0;
+    return finfo->strbuf;
+}
+
+CMDBM_STATIC void CMDBM_MySQL_ResultAssignString(
+		CMDBM_MySQL_FieldInfo *finfo, MYSQL_STMT *stmt, CMUTIL_JsonObject *row)
+{
+    const char *sval = CMDBM_MySQL_FetchString(finfo, stmt);
+    if (sval)
+        CMCall(row, PutString, finfo->name, sval);
+}
+
+CMDBM_STATIC void CMDBM_MySQL_GetDateTime(
+		CMDBM_MySQL_FieldInfo *finfo, CMDBM_DateTime *dt)
+{
+	MYSQL_TIME *t = &(finfo->timeVal);
+	memset(dt, 0x0, sizeof(CMDBM_DateTime));
+	dt->year = (int)t->year;
+	dt->month = (int)t->month;
+	dt->day = (int)t->day;
+	dt->hour = (int)t->hour;
+	dt->minute = (int)t->minute;
+	dt->second = (int)t->second;
+	dt->usec = (uint32_t)t->second_part;
+}
+
+CMDBM_STATIC void CMDBM_MySQL_ResultAssignTimestamp(
+		CMDBM_MySQL_FieldInfo *finfo, MYSQL_STMT *stmt, CMUTIL_JsonObject *row)
+{
+	CMDBM_DateTime dt;
+	CMDBM_MySQL_GetDateTime(finfo, &dt);
+	CMDBM_DateTimeFormat(&dt, finfo->textbuf);
+	CMUTIL_UNUSED(stmt);
+    CMCall(row, PutString, finfo->name, finfo->textbuf);
+}
+
+// DATE columns keep the driver's date only text in json rows.
+CMDBM_STATIC void CMDBM_MySQL_ResultAssignDate(
+		CMDBM_MySQL_FieldInfo *finfo, MYSQL_STMT *stmt, CMUTIL_JsonObject *row)
+{
+	MYSQL_TIME *t = &(finfo->timeVal);
+	sprintf(finfo->textbuf, "%04u-%02u-%02u", t->year, t->month, t->day);
 	CMUTIL_UNUSED(stmt);
+    CMCall(row, PutString, finfo->name, finfo->textbuf);
+}
+
+CMDBM_STATIC void CMDBM_MySQL_ResultAssignDecimal(
+		CMDBM_MySQL_FieldInfo *finfo, MYSQL_STMT *stmt, CMUTIL_JsonObject *row)
+{
+	finfo->numbuf[finfo->length] = 0x0;
+	CMUTIL_UNUSED(stmt);
+    CMCall(row, PutDouble, finfo->name, strtod(finfo->numbuf, NULL));
 }
 
 CMDBM_STATIC void CMDBM_MySQL_ResultAssignBoolean(
@@ -450,15 +565,17 @@ CMDBM_STATIC void CMDBM_MySQL_ResultAssignBoolean(
 CMDBM_STATIC MYSQL_STMT *CMDBM_MySQL_SelectBase(
 		CMDBM_MySQLSession *sess, CMUTIL_String *query, CMUTIL_JsonArray *binds,
 		CMUTIL_JsonObject *outs, CMUTIL_Array *fields, MYSQL_RES **meta,
-		MYSQL_BIND **resbuf)
+		MYSQL_BIND **resbuf, unsigned long prefetch)
 {
-	MYSQL_STMT *stmt = CMDBM_MySQL_ExecuteBase(sess, query, binds, outs);
+	MYSQL_STMT *stmt = CMDBM_MySQL_ExecuteBase(
+				sess, query, binds, outs, prefetch, NULL);
 	if (stmt) {
 		int i, fieldcnt;
 		MYSQL_FIELD *ofields = NULL;
         CMBool succ = CMFalse;
 
-		if (mysql_stmt_store_result(stmt) != 0) {
+		// cursor results are streamed, do not buffer them.
+		if (prefetch == 0 && mysql_stmt_store_result(stmt) != 0) {
 			MYSQL_LOGERROR(sess, "execute statement failed.");
 			goto FAILEDPOINT;
 		}
@@ -469,7 +586,7 @@ CMDBM_STATIC MYSQL_STMT *CMDBM_MySQL_SelectBase(
 			goto FAILEDPOINT;
 		}
 
-        fieldcnt = (int)mysql_field_count(sess->conn);
+        fieldcnt = (int)mysql_stmt_field_count(stmt);
 		ofields = mysql_fetch_fields(*meta);
         *resbuf = CMAlloc(sizeof(MYSQL_BIND) * (uint64_t)fieldcnt);
         memset(*resbuf, 0x0, sizeof(MYSQL_BIND) * (uint64_t)fieldcnt);
@@ -493,7 +610,6 @@ CMDBM_STATIC MYSQL_STMT *CMDBM_MySQL_SelectBase(
 			case MYSQL_TYPE_TINY:
 			case MYSQL_TYPE_SHORT:
 			case MYSQL_TYPE_LONG:
-			case MYSQL_TYPE_TIMESTAMP:
 			case MYSQL_TYPE_LONGLONG:
 			case MYSQL_TYPE_INT24:
 			case MYSQL_TYPE_ENUM:
@@ -504,10 +620,25 @@ CMDBM_STATIC MYSQL_STMT *CMDBM_MySQL_SelectBase(
                 finfo->jtype = CMJsonValueLong;
 				break;
 
+			case MYSQL_TYPE_DATE:
+			case MYSQL_TYPE_DATETIME:
+			case MYSQL_TYPE_TIMESTAMP:
+				// native time structure, formatted for json rows
+				if (f->type == MYSQL_TYPE_DATE) {
+					finfo->fassign = CMDBM_MySQL_ResultAssignDate;
+					finfo->isdate = 1;
+				} else {
+					finfo->fassign = CMDBM_MySQL_ResultAssignTimestamp;
+				}
+				b->buffer_type = MYSQL_TYPE_DATETIME;
+				b->buffer = &finfo->timeVal;
+				b->buffer_length = sizeof(MYSQL_TIME);
+                finfo->jtype = CMJsonValueString;
+				finfo->kind = CMDBM_ValueTimestamp;
+				break;
+
 			case MYSQL_TYPE_FLOAT:
 			case MYSQL_TYPE_DOUBLE:
-			case MYSQL_TYPE_DECIMAL:
-			case MYSQL_TYPE_NEWDECIMAL:
 				// treat as double
 				finfo->fassign = CMDBM_MySQL_ResultAssignDouble;
 				b->buffer_type = MYSQL_TYPE_DOUBLE;
@@ -515,6 +646,18 @@ CMDBM_STATIC MYSQL_STMT *CMDBM_MySQL_SelectBase(
                 finfo->jtype = CMJsonValueDouble;
 				break;
 
+			case MYSQL_TYPE_DECIMAL:
+			case MYSQL_TYPE_NEWDECIMAL:
+				// exact text is kept, json rows get double
+				finfo->fassign = CMDBM_MySQL_ResultAssignDecimal;
+				b->buffer_type = MYSQL_TYPE_STRING;
+				b->buffer = finfo->numbuf;
+				b->buffer_length = sizeof(finfo->numbuf) - 1;
+                finfo->jtype = CMJsonValueDouble;
+				finfo->kind = CMDBM_ValueDecimal;
+				finfo->scale = (int)f->decimals;
+				break;
+
 			default:
 				// treat as string
 				finfo->fassign = CMDBM_MySQL_ResultAssignString;
@@ -522,6 +665,9 @@ CMDBM_STATIC MYSQL_STMT *CMDBM_MySQL_SelectBase(
                 b->buffer = NULL;
                 b->buffer_length = 0;
                 finfo->jtype = CMJsonValueString;
+				// binary collation marks blob and (var)binary columns.
+				if (f->charsetnr == 63)
+					finfo->kind = CMDBM_ValueBinary;
 				break;
 			}
 			b->length = &(finfo->length);
@@ -566,8 +712,8 @@ CMDBM_STATIC void CMDBM_MySQL_FieldDestroy(void *data)
 {
 	CMDBM_MySQL_FieldInfo *finfo = (CMDBM_MySQL_FieldInfo*)data;
 	if (finfo) {
-        if (finfo->jtype == CMJsonValueString && finfo->bind->buffer)
-            CMFree(finfo->bind->buffer);
+        if (finfo->strbuf)
+            CMFree(finfo->strbuf);
 		CMFree(finfo);
 	}
 }
@@ -582,7 +728,7 @@ CMDBM_STATIC CMUTIL_JsonObject *CMDBM_MySQL_GetRow(
 	MYSQL_RES *meta = NULL;
 	MYSQL_BIND *resb = NULL;
 	MYSQL_STMT *stmt = CMDBM_MySQL_SelectBase(
-				sess, query, binds, outs, fields, &meta, &resb);
+				sess, query, binds, outs, fields, &meta, &resb, 0);
 	CMUTIL_JsonObject *res = NULL;
     CMBool succ = CMFalse;
 
@@ -647,7 +793,7 @@ CMDBM_STATIC CMUTIL_JsonArray *CMDBM_MySQL_GetList(
 	MYSQL_RES *meta = NULL;
 	MYSQL_BIND *resb = NULL;
 	MYSQL_STMT *stmt = CMDBM_MySQL_SelectBase(
-				sess, query, binds, outs, fields, &meta, &resb);
+				sess, query, binds, outs, fields, &meta, &resb, 0);
 	CMUTIL_JsonArray *res = CMUTIL_JsonArrayCreate();
     CMBool succ = CMFalse;
 
@@ -690,7 +836,25 @@ CMDBM_STATIC int CMDBM_MySQL_Execute(
 		CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
 {
 	CMDBM_MySQLSession *sess = (CMDBM_MySQLSession*)connection;
-	MYSQL_STMT *stmt = CMDBM_MySQL_ExecuteBase(sess, query, binds, outs);
+	MYSQL_STMT *stmt = CMDBM_MySQL_ExecuteBase(
+				sess, query, binds, outs, 0, NULL);
+	if (stmt) {
+		int res = (int)mysql_stmt_affected_rows(stmt);
+		mysql_stmt_close(stmt);
+		return res;
+	}
+	CMUTIL_UNUSED(initres);
+	return -1;
+}
+
+CMDBM_STATIC int CMDBM_MySQL_ExecuteLob(
+		void *initres, void *connection,
+		CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs,
+		CMDBM_LobSource **lobs)
+{
+	CMDBM_MySQLSession *sess = (CMDBM_MySQLSession*)connection;
+	MYSQL_STMT *stmt = CMDBM_MySQL_ExecuteBase(
+				sess, query, binds, outs, 0, lobs);
 	if (stmt) {
 		int res = (int)mysql_stmt_affected_rows(stmt);
 		mysql_stmt_close(stmt);
@@ -718,7 +882,8 @@ CMDBM_STATIC void *CMDBM_MySQL_OpenCursor(
 	MYSQL_RES *meta = NULL;
 	MYSQL_BIND *resb = NULL;
 	MYSQL_STMT *stmt = CMDBM_MySQL_SelectBase(
-				sess, query, binds, outs, fields, &meta, &resb);
+				sess, query, binds, outs, fields, &meta, &resb,
+				sess->fetchsize > 0? sess->fetchsize:CMDBM_MYSQL_PREFETCH_ROWS);
 	if (stmt) {
 		CMDBM_MySQL_Cursor *res = CMAlloc(sizeof(CMDBM_MySQL_Cursor));
 		memset(res, 0x0, sizeof(CMDBM_MySQL_Cursor));
@@ -746,7 +911,6 @@ CMDBM_STATIC void CMDBM_MySQL_CloseCursor(void *cursor)
 {
 	CMDBM_MySQL_Cursor *csr = (CMDBM_MySQL_Cursor*)cursor;
 	if (csr) {
-        if (csr->fields) CMCall(csr->fields, Destroy);
 		if (csr->meta) mysql_free_result(csr->meta);
 		if (csr->stmt) {
 			mysql_stmt_free_result(csr->stmt);
@@ -759,19 +923,157 @@ CMDBM_STATIC void CMDBM_MySQL_CloseCursor(void *cursor)
 	}
 }
 
-CMDBM_STATIC CMUTIL_JsonObject *CMDBM_MySQL_CursorNextRow(void *cursor)
+CMDBM_STATIC CMBool CMDBM_MySQL_CursorFetch(void *cursor)
 {
 	CMDBM_MySQL_Cursor *csr = (CMDBM_MySQL_Cursor*)cursor;
 	if (csr) {
-		if (mysql_stmt_fetch(csr->stmt) == 0) {
-			CMUTIL_JsonObject *res = CMUTIL_JsonObjectCreate();
-			CMUTIL_MySQL_RowSetFields(csr->fields, csr->stmt, res);
-			return res;
-		}
+		// string columns are bound without buffer, so truncation is normal.
+		int rval = mysql_stmt_fetch(csr->stmt);
+		if (rval == 0 || rval == MYSQL_DATA_TRUNCATED)
+			return CMTrue;
+		else if (rval == 1)
+			MYSQL_LOGERROR(csr->sess, "fetch row failed.");
+	}
+	return CMFalse;
+}
+
+CMDBM_STATIC CMUTIL_JsonObject *CMDBM_MySQL_CursorNextRow(void *cursor)
+{
+	CMDBM_MySQL_Cursor *csr = (CMDBM_MySQL_Cursor*)cursor;
+	if (CMDBM_MySQL_CursorFetch(csr)) {
+		CMUTIL_JsonObject *res = CMUTIL_JsonObjectCreate();
+		CMUTIL_MySQL_RowSetFields(csr->fields, csr->stmt, res);
+		return res;
 	}
 	return NULL;
 }
 
+CMDBM_STATIC uint32_t CMDBM_MySQL_CursorColumnCount(void *cursor)
+{
+	CMDBM_MySQL_Cursor *csr = (CMDBM_MySQL_Cursor*)cursor;
+	return (uint32_t)CMCall(csr->fields, GetSize);
+}
+
+CMDBM_STATIC const char *CMDBM_MySQL_CursorColumnName(
+		void *cursor, uint32_t index)
+{
+	CMDBM_MySQL_Cursor *csr = (CMDBM_MySQL_Cursor*)cursor;
+	CMDBM_MySQL_FieldInfo *finfo =
+			(CMDBM_MySQL_FieldInfo*)CMCall(csr->fields, GetAt, index);
+	return finfo? finfo->name:NULL;
+}
+
+CMDBM_STATIC CMJsonValueType CMDBM_MySQL_CursorColumnType(
+		void *cursor, uint32_t index)
+{
+	CMDBM_MySQL_Cursor *csr = (CMDBM_MySQL_Cursor*)cursor;
+	CMDBM_MySQL_FieldInfo *finfo =
+			(CMDBM_MySQL_FieldInfo*)CMCall(csr->fields, GetAt, index);
+	return finfo? finfo->jtype:CMJsonValueNull;
+}
+
+CMDBM_STATIC CMBool CMDBM_MySQL_CursorGetValue(
+		void *cursor, uint32_t index, CMDBM_ColumnValue *value)
+{
+	CMDBM_MySQL_Cursor *csr = (CMDBM_MySQL_Cursor*)cursor;
+	CMDBM_MySQL_FieldInfo *finfo =
+			(CMDBM_MySQL_FieldInfo*)CMCall(csr->fields, GetAt, index);
+	if (finfo == NULL)
+		return CMFalse;
+	value->length = 0;
+	if (finfo->isnull) {
+		value->type = CMJsonValueNull;
+		return CMTrue;
+	}
+	value->type = finfo->jtype;
+	if (finfo->kind == CMDBM_ValueTimestamp) {
+		CMDBM_DateTime dt;
+		CMDBM_MySQL_GetDateTime(finfo, &dt);
+		CMDBM_DateTimeToValue(&dt, finfo->textbuf, value);
+		if (finfo->isdate) {
+			// same text as json rows, "YYYY-MM-DD" part of the timestamp.
+			value->length = (size_t)(strchr(finfo->textbuf, ' ') -
+									 finfo->textbuf);
+			finfo->textbuf[value->length] = 0x0;
+		}
+		return CMTrue;
+	} else if (finfo->kind == CMDBM_ValueDecimal) {
+		finfo->numbuf[finfo->length] = 0x0;
+		value->u.dval = strtod(finfo->numbuf, NULL);
+		CMDBM_DecimalToValue(
+					finfo->numbuf, finfo->length, finfo->scale, value);
+		return CMTrue;
+	}
+	switch (finfo->jtype) {
+	case CMJsonValueLong:
+		value->u.lval = finfo->longVal;
+		break;
+	case CMJsonValueDouble:
+		value->u.dval = finfo->doubleVal;
+		break;
+	case CMJsonValueBoolean:
+		value->u.bval = finfo->longVal? CMTrue:CMFalse;
+		break;
+	default:
+		value->u.sval = CMDBM_MySQL_FetchString(finfo, csr->stmt);
+		if (value->u.sval == NULL)
+			return CMFalse;
+		value->length = finfo->length;
+		if (finfo->kind == CMDBM_ValueBinary) {
+			value->kind = CMDBM_ValueBinary;
+			value->native.bin.data = value->u.sval;
+			value->native.bin.length = finfo->length;
+		}
+	}
+	return CMTrue;
+}
+
+CMDBM_STATIC int64_t CMDBM_MySQL_CursorReadLob(
+		void *cursor, uint32_t index, CMBool restart, void *buf, size_t size)
+{
+	CMDBM_MySQL_Cursor *csr = (CMDBM_MySQL_Cursor*)cursor;
+	CMDBM_MySQL_FieldInfo *finfo =
+			(CMDBM_MySQL_FieldInfo*)CMCall(csr->fields, GetAt, index);
+	MYSQL_BIND *bind = NULL;
+	unsigned long n;
+	int ival;
+	if (finfo == NULL || finfo->jtype != CMJsonValueString ||
+			finfo->kind == CMDBM_ValueTimestamp) {
+		CMLogError("column %u is not character or binary column.", index);
+		return -1;
+	}
+	if (restart)
+		finfo->lobpos = 0;
+	if (finfo->isnull || finfo->lobpos >= finfo->length)
+		return 0;
+	n = finfo->length - finfo->lobpos;
+	if (n > size)
+		n = (unsigned long)size;
+	// column is fetched piece by piece straight into caller buffer.
+	bind = finfo->bind;
+	bind->buffer = buf;
+	bind->buffer_length = n;
+	ival = mysql_stmt_fetch_column(
+				csr->stmt, bind, (uint32_t)finfo->index, finfo->lobpos);
+	bind->buffer = NULL;
+	bind->buffer_length = 0;
+	if (ival != 0) {
+		MYSQL_LOGERROR(csr->sess, "mysql_stmt_fetch_column() failed.");
+		return -1;
+	}
+	finfo->lobpos += n;
+	return (int64_t)n;
+}
+
+CMDBM_STATIC void CMDBM_MySQL_SetFetchSize(
+		void *initres, void *connection, uint32_t rows)
+{
+	CMDBM_MySQLSession *sess = (CMDBM_MySQLSession*)connection;
+	if (sess)
+		sess->fetchsize = rows;
+	CMUTIL_UNUSED(initres);
+}
+
 CMDBM_STATIC void CMDBM_MySQL_LibraryInit()
 {
 	mysql_library_init(0, NULL, NULL);
@@ -782,6 +1084,18 @@ CMDBM_STATIC void CMDBM_MySQL_LibraryClear()
 	mysql_library_end();
 }
 
+CMDBM_STATIC void CMDBM_MySQL_ThreadInit(void *initres)
+{
+	mysql_thread_init();
+	CMUTIL_UNUSED(initres);
+}
+
+CMDBM_STATIC void CMDBM_MySQL_ThreadEnd(void *initres)
+{
+	mysql_thread_end();
+	CMUTIL_UNUSED(initres);
+}
+
 CMDBM_ModuleInterface g_cmdbm_mysql_interface = {
 	CMDBM_MySQL_LibraryInit,
 	CMDBM_MySQL_LibraryClear,
@@ -802,7 +1116,20 @@ CMDBM_ModuleInterface g_cmdbm_mysql_interface = {
 	CMDBM_MySQL_Execute,
 	CMDBM_MySQL_OpenCursor,
 	CMDBM_MySQL_CloseCursor,
-	CMDBM_MySQL_CursorNextRow
+	CMDBM_MySQL_CursorNextRow,
+	NULL, NULL,
+	CMDBM_MySQL_SetFetchSize,
+	CMDBM_MySQL_CursorColumnCount,
+	CMDBM_MySQL_CursorColumnName,
+	CMDBM_MySQL_CursorFetch,
+	CMDBM_MySQL_CursorGetValue,
+	CMDBM_MySQL_CursorColumnType,
+	CMDBM_MySQL_CursorReadLob,
+	CMDBM_MySQL_ExecuteLob,
+	CMDBM_MySQL_PingConnection,
+	CMDBM_MySQL_ThreadInit,
+	CMDBM_MySQL_ThreadEnd,
+	NULL
 };
 
 #endif
@@ -13,6 +13,11 @@ CMUTIL_LogDefine("cmdbm.module.odbc")
 #endif
 #include <sqlext.h>
 
+// rows per block cursor fetch when fetch size is not given.
+#define CMDBM_ODBC_FETCH_ROWS       100
+// character columns wider than this are not bound, but read with SQLGetData.
+#define CMDBM_ODBC_MAX_BOUND_CHARS  4000
+
 /*******************************************/
 /* Macro to call ODBC functions and        */
 /* report an error on failure.             */
@@ -60,6 +65,8 @@ typedef struct CMDBM_ODBCCtx {
 typedef struct CMDBM_ODBCSession {
     CMDBM_ODBCCtx   *ctx;
     SQLHDBC         conn;
+    uint32_t        fetchsize;
+    int             dummy_padder;
 } CMDBM_ODBCSession;
 
 CMDBM_STATIC const char *CMDBM_ODBC_GetDBMSKey()
@@ -125,6 +132,20 @@ CMDBM_STATIC void CMDBM_ODBC_CloseConnection(
     CMUTIL_UNUSED(initres);
 }
 
+CMDBM_STATIC CMBool CMDBM_ODBC_PingConnection(
+        void *initres, void *connection)
+{
+    CMDBM_ODBCSession *sess = (CMDBM_ODBCSession*)connection;
+    SQLUINTEGER dead = SQL_CD_FALSE;
+    CMUTIL_UNUSED(initres);
+    // driver answers from its own state, drivers without it are trusted.
+    if (!SQL_SUCCEEDED(SQLGetConnectAttr(
+                           sess->conn, SQL_ATTR_CONNECTION_DEAD,
+                           &dead, SQL_IS_UINTEGER, NULL)))
+        return CMTrue;
+    return dead == SQL_CD_TRUE? CMFalse:CMTrue;
+}
+
 CMDBM_STATIC void *CMDBM_ODBC_OpenConnection(
         void *initres, CMUTIL_JsonObject *params)
 {
@@ -185,16 +206,6 @@ FAILED:
     return CMFalse;
 }
 
-CMDBM_STATIC void CMDBM_ODBC_EndTransaction(
-        void *initres, void *connection)
-{
-    CMDBM_ODBCSession *sess = (CMDBM_ODBCSession*)connection;
-    TRYODBC(sess->conn, SQL_HANDLE_DBC, SQLSetConnectAttr(
-                sess->conn, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)1, 0));
-FAILED:
-    CMUTIL_UNUSED(initres);
-}
-
 CMDBM_STATIC CMBool CMDBM_ODBC_CommitTransaction(
         void *initres, void *connection)
 {
@@ -218,6 +229,18 @@ FAILED:
     CMUTIL_UNUSED(initres);
 }
 
+CMDBM_STATIC void CMDBM_ODBC_EndTransaction(
+        void *initres, void *connection)
+{
+    CMDBM_ODBCSession *sess = (CMDBM_ODBCSession*)connection;
+    // most drivers commit open work when autocommit is enabled.
+    CMDBM_ODBC_RollbackTransaction(initres, connection);
+    TRYODBC(sess->conn, SQL_HANDLE_DBC, SQLSetConnectAttr(
+                sess->conn, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)1, 0));
+FAILED:
+    CMUTIL_UNUSED(initres);
+}
+
 typedef struct CMDBM_ODBC_BindField CMDBM_ODBC_BindField;
 struct CMDBM_ODBC_BindField {
     int64_t                 longVal;
@@ -226,10 +249,22 @@ struct CMDBM_ODBC_BindField {
     char                    *name;
     void                    (*fassign)(
                                     CMDBM_ODBC_BindField*, SQLHSTMT,
-                                    CMUTIL_JsonObject*, SQLUSMALLINT);
+                                    CMUTIL_JsonObject*, SQLUSMALLINT,
+                                    SQLULEN);
+    char                    *values;    // column-wise result array
+    SQLLEN                  *lens;      // length/indicator array
+    SQLLEN                  width;      // bytes of one element in values
+    char                    *getbuf;    // SQLGetData buffer, reused
+    size_t                  getcap;
+    uint64_t                getseq;     // row sequence of getbuf contents
+    size_t                  lobpos;     // read offset of bound lob reader
     SQLLEN                  outLen;
     CMJsonValueType         jtype;
+    CMDBM_ValueKind         kind;
+    char                    textbuf[CMDBM_DATETIME_BUFSZ];
     short                   boolVal;
+    SQLSMALLINT             ctype;
+    SQLSMALLINT             scale;
     short                   dummy_padder;
 };
 
@@ -245,6 +280,9 @@ void CMDBM_ODBC_BindFieldDestroy(void *data) {
     if (field) {
         if (field->strVal) CMFree(field->strVal);
         if (field->name) CMFree(field->name);
+        if (field->values) CMFree(field->values);
+        if (field->lens) CMFree(field->lens);
+        if (field->getbuf) CMFree(field->getbuf);
         CMFree(field);
     }
 }
@@ -426,10 +464,62 @@ CMDBM_STATIC void CMDBM_ODBC_SetOutValue(
     }
 }
 
+CMDBM_STATIC CMBool CMDBM_ODBC_BindLob(
+        SQLHSTMT stmt, CMDBM_LobSource *lob,
+        CMUTIL_Array *bufarr, uint32_t index)
+{
+    CMDBM_ODBC_BindField *bfield =
+            CMDBM_ODBC_BindFieldCreate(CMJsonValueString);
+    // source is given back by SQLParamData as parameter token.
+    bfield->outLen = SQL_LEN_DATA_AT_EXEC(0);
+    TRYODBC(stmt, SQL_HANDLE_STMT, SQLBindParameter(
+                stmt, (SQLUSMALLINT)(index+1), SQL_PARAM_INPUT,
+                lob->binary? SQL_C_BINARY:SQL_C_CHAR,
+                lob->binary? SQL_LONGVARBINARY:SQL_LONGVARCHAR,
+                0, 0, (SQLPOINTER)lob, 0, &bfield->outLen));
+    CMCall(bufarr, Add, bfield, NULL);
+    return CMTrue;
+FAILED:
+    CMDBM_ODBC_BindFieldDestroy(bfield);
+    return CMFalse;
+}
+
+CMDBM_STATIC SQLRETURN CMDBM_ODBC_PutLobs(SQLHSTMT stmt)
+{
+    SQLRETURN sr;
+    SQLPOINTER token = NULL;
+    char *chunk = CMAlloc(CMDBM_LOB_CHUNK);
+    while ((sr = SQLParamData(stmt, &token)) == SQL_NEED_DATA) {
+        CMDBM_LobSource *lob = (CMDBM_LobSource*)token;
+        int64_t n;
+        CMBool sent = CMFalse;
+        while ((n = lob->read(chunk, CMDBM_LOB_CHUNK, lob->udata)) > 0) {
+            TRYODBC(stmt, SQL_HANDLE_STMT,
+                    SQLPutData(stmt, chunk, (SQLLEN)n));
+            sent = CMTrue;
+        }
+        if (n < 0) {
+            CMLogError("reading lob source '%s' failed.", lob->name);
+            goto FAILED;
+        }
+        // empty value still needs one put call.
+        if (!sent)
+            TRYODBC(stmt, SQL_HANDLE_STMT, SQLPutData(stmt, chunk, 0));
+    }
+    CMFree(chunk);
+    return sr;
+FAILED:
+    CMFree(chunk);
+    SQLCancel(stmt);
+    return SQL_ERROR;
+}
+
 CMDBM_STATIC SQLHSTMT CMDBM_ODBC_ExecuteBase(
         CMDBM_ODBCSession *sess, CMUTIL_String *query,
-        CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
+        CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs,
+        CMDBM_LobSource **lobs)
 {
+    SQLRETURN sr;
     uint32_t i;
     size_t bsize = 0;
     CMBool succ = CMFalse;
@@ -454,7 +544,10 @@ CMDBM_STATIC SQLHSTMT CMDBM_ODBC_ExecuteBase(
         char ibuf[20];
         CMUTIL_Json *json = CMCall(binds, Get, i);
         sprintf(ibuf, "%d", i);
-        if (CMCall(json, GetType) == CMJsonTypeValue) {
+        if (lobs && lobs[i]) {
+            if (!CMDBM_ODBC_BindLob(stmt, lobs[i], array, i))
+                goto FAILED;
+        } else if (CMCall(json, GetType) == CMJsonTypeValue) {
             CMUTIL_JsonValue *jval = (CMUTIL_JsonValue*)json;
             CMJsonValueType jtype = CMCall(jval, GetValueType);
             CMUTIL_Json *out = CMCall(outs, Get, ibuf);
@@ -466,7 +559,11 @@ CMDBM_STATIC SQLHSTMT CMDBM_ODBC_ExecuteBase(
         }
     }
 
-    TRYODBC(stmt, SQL_HANDLE_STMT, SQLExecute (stmt));
+    sr = SQLExecute(stmt);
+    // streamed parameters are requested one by one.
+    if (sr == SQL_NEED_DATA)
+        sr = CMDBM_ODBC_PutLobs(stmt);
+    TRYODBC(stmt, SQL_HANDLE_STMT, sr);
 
     if (binds && outs) {
         CMUTIL_StringArray *keys = CMCall(outs, GetKeys);
@@ -494,62 +591,159 @@ FAILED:
 
 CMDBM_STATIC void CMDBM_ODBC_ResultAssignLong(
         CMDBM_ODBC_BindField *finfo, SQLHSTMT stmt,
-        CMUTIL_JsonObject *row, SQLUSMALLINT idx)
+        CMUTIL_JsonObject *row, SQLUSMALLINT idx, SQLULEN ridx)
 {
+    int64_t lval = ((int64_t*)finfo->values)[ridx];
     CMUTIL_UNUSED(stmt, idx);
-    CMCall(row, PutLong, finfo->name, finfo->longVal);
+    CMCall(row, PutLong, finfo->name, lval);
 }
 
 CMDBM_STATIC void CMDBM_ODBC_ResultAssignDouble(
         CMDBM_ODBC_BindField *finfo, SQLHSTMT stmt,
-        CMUTIL_JsonObject *row, SQLUSMALLINT idx)
+        CMUTIL_JsonObject *row, SQLUSMALLINT idx, SQLULEN ridx)
 {
+    double dval = ((double*)finfo->values)[ridx];
     CMUTIL_UNUSED(stmt, idx);
-    CMCall(row, PutDouble, finfo->name, finfo->doubleVal);
+    CMCall(row, PutDouble, finfo->name, dval);
 }
 
-CMDBM_STATIC void CMDBM_ODBC_ResultAssignString(
+CMDBM_STATIC void CMDBM_ODBC_GetDateTime(
+        CMDBM_ODBC_BindField *finfo, SQLULEN ridx, CMDBM_DateTime *dt)
+{
+    SQL_TIMESTAMP_STRUCT *ts = ((SQL_TIMESTAMP_STRUCT*)finfo->values) + ridx;
+    memset(dt, 0x0, sizeof(CMDBM_DateTime));
+    dt->year = (int)ts->year;
+    dt->month = (int)ts->month;
+    dt->day = (int)ts->day;
+    dt->hour = (int)ts->hour;
+    dt->minute = (int)ts->minute;
+    dt->second = (int)ts->second;
+    // fraction is in nanoseconds.
+    dt->usec = (uint32_t)(ts->fraction / 1000);
+}
+
+CMDBM_STATIC void CMDBM_ODBC_ResultAssignTimestamp(
+        CMDBM_ODBC_BindField *finfo, SQLHSTMT stmt,
+        CMUTIL_JsonObject *row, SQLUSMALLINT idx, SQLULEN ridx)
+{
+    CMDBM_DateTime dt;
+    CMUTIL_UNUSED(stmt, idx);
+    CMDBM_ODBC_GetDateTime(finfo, ridx, &dt);
+    CMDBM_DateTimeFormat(&dt, finfo->textbuf);
+    CMCall(row, PutString, finfo->name, finfo->textbuf);
+}
+
+CMDBM_STATIC void CMDBM_ODBC_ResultAssignDecimal(
+        CMDBM_ODBC_BindField *finfo, SQLHSTMT stmt,
+        CMUTIL_JsonObject *row, SQLUSMALLINT idx, SQLULEN ridx)
+{
+    const char *text = finfo->values + (finfo->width * (SQLLEN)ridx);
+    CMUTIL_UNUSED(stmt, idx);
+    CMCall(row, PutDouble, finfo->name, strtod(text, NULL));
+}
+
+// binary values are given as hex text in json rows.
+CMDBM_STATIC const char *CMDBM_ODBC_BinaryHex(
+        CMDBM_ODBC_BindField *finfo, SQLULEN ridx, size_t *length)
+{
+    size_t len = (size_t)finfo->lens[ridx];
+    finfo->getbuf = (char*)CMDBM_BufferGrow(
+                finfo->getbuf, &finfo->getcap, len * 2 + 1, 0);
+    *length = CMDBM_HexEncode(
+                finfo->values + (finfo->width * (SQLLEN)ridx),
+                len, finfo->getbuf);
+    return finfo->getbuf;
+}
+
+CMDBM_STATIC void CMDBM_ODBC_ResultAssignBinary(
         CMDBM_ODBC_BindField *finfo, SQLHSTMT stmt,
-        CMUTIL_JsonObject *row, SQLUSMALLINT idx)
+        CMUTIL_JsonObject *row, SQLUSMALLINT idx, SQLULEN ridx)
+{
+    size_t length = 0;
+    CMUTIL_UNUSED(stmt, idx);
+    CMCall(row, PutString, finfo->name,
+           CMDBM_ODBC_BinaryHex(finfo, ridx, &length));
+}
+
+/*
+ * Reads unbound character column with SQLGetData into 'getbuf'.
+ * 'outLen' is set to read length or SQL_NULL_DATA.
+ */
+CMDBM_STATIC CMBool CMDBM_ODBC_GetDataString(
+        CMDBM_ODBC_BindField *finfo, SQLHSTMT stmt, SQLUSMALLINT idx)
 {
     SQLRETURN sr = SQL_SUCCESS;
-    SQLLEN size = 0, bytes = 0;
-    CMUTIL_String *strbuf = NULL;
-    SQLCHAR buf[1024];
-    CMCall(row, PutString, finfo->name, "");
-    strbuf = (CMUTIL_String*)CMCall(row, GetString, finfo->name);
+    SQLLEN size = 0, avail = 0;
+    size_t offset = 0;
+    // read into the column buffer which is kept for following rows.
+    finfo->getbuf = (char*)CMDBM_BufferGrow(
+                finfo->getbuf, &finfo->getcap, 1024, 0);
     while (CMTrue) {
-        sr = SQLGetData(stmt, idx, SQL_C_CHAR, buf, sizeof(buf), &size);
+        avail = (SQLLEN)(finfo->getcap - offset);
+        sr = SQLGetData(stmt, idx, SQL_C_CHAR,
+                        finfo->getbuf + offset, avail, &size);
         if (sr == SQL_NO_DATA_FOUND)
             break;
         TRYODBC(stmt, SQL_HANDLE_STMT, sr);
         if (size == SQL_NULL_DATA) {
-            CMCall(row, PutNull, finfo->name);
+            finfo->outLen = SQL_NULL_DATA;
+            return CMTrue;
+        }
+        if (size != SQL_NO_TOTAL && size < avail) {
+            offset += (size_t)size;
             break;
         }
-        bytes = (size > 1024) || (size == SQL_NO_TOTAL) ?
-                          1024 : size;
-        CMCall(strbuf, AddNString, (char*)buf, (uint64_t)bytes);
+        // truncated, the last byte of this piece is a terminator.
+        offset += (size_t)(avail - 1);
+        finfo->getbuf = (char*)CMDBM_BufferGrow(
+                    finfo->getbuf, &finfo->getcap,
+                    size == SQL_NO_TOTAL? finfo->getcap * 2:
+                                          offset + (size_t)size + 2 - avail,
+                    offset);
     }
+    finfo->getbuf[offset] = 0x0;
+    finfo->outLen = (SQLLEN)offset;
+    return CMTrue;
 FAILED:
-    // does nothing to do
-    ;
+    return CMFalse;
+}
+
+CMDBM_STATIC void CMDBM_ODBC_ResultAssignString(
+        CMDBM_ODBC_BindField *finfo, SQLHSTMT stmt,
+        CMUTIL_JsonObject *row, SQLUSMALLINT idx, SQLULEN ridx)
+{
+    if (finfo->values) {
+        // bound column, driver terminates the value in its slot.
+        CMCall(row, PutString, finfo->name,
+               finfo->values + (finfo->width * (SQLLEN)ridx));
+    } else if (CMDBM_ODBC_GetDataString(finfo, stmt, idx)) {
+        if (finfo->outLen == SQL_NULL_DATA)
+            CMCall(row, PutNull, finfo->name);
+        else
+            CMCall(row, PutString, finfo->name, finfo->getbuf);
+    }
 }
 
 CMDBM_STATIC void CMDBM_ODBC_ResultAssignBoolean(
         CMDBM_ODBC_BindField *finfo, SQLHSTMT stmt,
-        CMUTIL_JsonObject *row, SQLUSMALLINT idx)
+        CMUTIL_JsonObject *row, SQLUSMALLINT idx, SQLULEN ridx)
 {
-    CMBool bval = finfo->boolVal? CMTrue:CMFalse;
+    CMBool bval = ((short*)finfo->values)[ridx]? CMTrue:CMFalse;
     CMUTIL_UNUSED(stmt, idx);
     CMCall(row, PutBoolean, finfo->name, bval);
 }
 
+/*
+ * Describes result columns and binds them as column-wise arrays of
+ * '*arrsz' elements. If any column cannot be bound (long or unbounded
+ * character data), '*arrsz' is lowered to 1 and those columns are read
+ * with SQLGetData, which is not available for block cursors.
+ */
 CMDBM_STATIC SQLHSTMT CMDBM_ODBC_SelectBase(
         CMDBM_ODBCSession *sess, CMUTIL_String *query, CMUTIL_JsonArray *binds,
-        CMUTIL_JsonObject *outs, CMUTIL_Array *fields)
+        CMUTIL_JsonObject *outs, CMUTIL_Array *fields, SQLULEN *arrsz)
 {
-    SQLHSTMT stmt = CMDBM_ODBC_ExecuteBase(sess, query, binds, outs);
+    SQLHSTMT stmt = CMDBM_ODBC_ExecuteBase(sess, query, binds, outs, NULL);
     if (stmt) {
         int i;
         SQLSMALLINT numcols;
@@ -584,24 +778,28 @@ CMDBM_STATIC SQLHSTMT CMDBM_ODBC_SelectBase(
             switch (dtype) {
             case SQL_DECIMAL:
             case SQL_NUMERIC:
+                // exact text is kept, json rows get double
+                col->jtype = CMJsonValueDouble;
+                col->kind = CMDBM_ValueDecimal;
+                col->fassign = CMDBM_ODBC_ResultAssignDecimal;
+                col->ctype = SQL_C_CHAR;
+                col->scale = digits;
+                // precision digits with sign, point and terminator.
+                col->width = (SQLLEN)(dsize > 0 && dsize <= 76? dsize + 3:80);
+                break;
             case SQL_REAL:
             case SQL_FLOAT:
             case SQL_DOUBLE:
                 col->jtype = CMJsonValueDouble;
                 col->fassign = CMDBM_ODBC_ResultAssignDouble;
-                TRYODBC(stmt, SQL_HANDLE_STMT, SQLBindCol(
-                            stmt, (SQLUSMALLINT)i+1, SQL_C_DOUBLE,
-                            &col->doubleVal, sizeof(double), &col->outLen));
+                col->ctype = SQL_C_DOUBLE;
+                col->width = sizeof(double);
                 break;
             case SQL_SMALLINT:
             case SQL_INTEGER:
             case SQL_TINYINT:
             case SQL_BIGINT:
             // TODO: treat as long type currently
-            case SQL_TYPE_DATE:
-            case SQL_TYPE_TIME:
-            case SQL_TYPE_TIMESTAMP:
-            // TODO: treat as long type currently
             case SQL_INTERVAL_MONTH:
             case SQL_INTERVAL_YEAR:
             case SQL_INTERVAL_YEAR_TO_MONTH:
@@ -617,34 +815,72 @@ CMDBM_STATIC SQLHSTMT CMDBM_ODBC_SelectBase(
             case SQL_INTERVAL_MINUTE_TO_SECOND:
                 col->jtype = CMJsonValueLong;
                 col->fassign = CMDBM_ODBC_ResultAssignLong;
-                TRYODBC(stmt, SQL_HANDLE_STMT, SQLBindCol(
-                            stmt, (SQLUSMALLINT)i+1, SQL_C_LONG,
-                            &col->longVal, sizeof(int64_t), &col->outLen));
+                col->ctype = SQL_C_SBIGINT;
+                col->width = sizeof(int64_t);
+                break;
+            case SQL_TYPE_DATE:
+            case SQL_TYPE_TIMESTAMP:
+                // native timestamp structure, formatted for json rows
+                col->jtype = CMJsonValueString;
+                col->kind = CMDBM_ValueTimestamp;
+                col->fassign = CMDBM_ODBC_ResultAssignTimestamp;
+                col->ctype = SQL_C_TYPE_TIMESTAMP;
+                col->width = sizeof(SQL_TIMESTAMP_STRUCT);
+                break;
+            case SQL_BINARY:
+            case SQL_VARBINARY:
+                col->jtype = CMJsonValueString;
+                col->fassign = CMDBM_ODBC_ResultAssignString;
+                col->ctype = SQL_C_CHAR;
+                // raw bytes when bounded, otherwise hex text of driver.
+                if (dsize > 0 && dsize <= CMDBM_ODBC_MAX_BOUND_CHARS) {
+                    col->kind = CMDBM_ValueBinary;
+                    col->fassign = CMDBM_ODBC_ResultAssignBinary;
+                    col->ctype = SQL_C_BINARY;
+                    col->width = (SQLLEN)dsize;
+                }
                 break;
             case SQL_BIT:
                 col->jtype = CMJsonValueBoolean;
                 col->fassign = CMDBM_ODBC_ResultAssignBoolean;
-                TRYODBC(stmt, SQL_HANDLE_STMT, SQLBindCol(
-                            stmt, (SQLUSMALLINT)i+1, SQL_C_LONG,
-                            &col->boolVal, sizeof(short), &col->outLen));
+                col->ctype = SQL_C_SSHORT;
+                col->width = sizeof(short);
+                break;
+            case SQL_LONGVARCHAR:
+            case SQL_WLONGVARCHAR:
+            case SQL_LONGVARBINARY:
+                col->jtype = CMJsonValueString;
+                col->fassign = CMDBM_ODBC_ResultAssignString;
+                col->ctype = SQL_C_CHAR;
                 break;
             case SQL_CHAR:
             case SQL_VARCHAR:
-            case SQL_LONGVARCHAR:
             case SQL_WCHAR:
             case SQL_WVARCHAR:
-            case SQL_WLONGVARCHAR:
-            case SQL_BINARY:
-            case SQL_VARBINARY:
-            case SQL_LONGVARBINARY:
+            case SQL_TYPE_TIME:
             default:
                 col->jtype = CMJsonValueString;
                 col->fassign = CMDBM_ODBC_ResultAssignString;
-//                TRYODBC(stmt, SQL_HANDLE_STMT, SQLBindCol(
-//                            stmt, (SQLUSMALLINT)i+1, SQL_C_CHAR, NULL,
-//                            0, &col->outLen));
+                col->ctype = SQL_C_CHAR;
+                // room for multibyte characters.
+                if (dsize > 0 && dsize <= CMDBM_ODBC_MAX_BOUND_CHARS)
+                    col->width = (SQLLEN)(dsize * 4 + 1);
                 break;
             }
+            if (col->width == 0)
+                *arrsz = 1;
+        }
+
+        for (i=0; i<numcols; i++) {
+            CMDBM_ODBC_BindField *col =
+                    (CMDBM_ODBC_BindField*)CMCall(fields, GetAt, (uint32_t)i);
+            if (col->width == 0)
+                continue;
+            col->values = CMAlloc((uint64_t)(col->width * (SQLLEN)*arrsz));
+            col->lens = CMAlloc(sizeof(SQLLEN) * *arrsz);
+            TRYODBC(stmt, SQL_HANDLE_STMT, SQLBindCol(
+                        stmt, (SQLUSMALLINT)i+1, col->ctype,
+                        col->values, col->width, col->lens));
         }
 
         succ = CMTrue;
@@ -657,20 +893,134 @@ FAILED:
     return stmt;
 }
 
-CMDBM_STATIC void CMUTIL_ODBC_RowSetFields(
-        CMUTIL_Array *finfos, SQLHSTMT stmt, CMUTIL_JsonObject *row)
+typedef struct CMDBM_ODBC_Cursor {
+    CMDBM_ODBCSession   *sess;
+    SQLHSTMT            stmt;
+    CMUTIL_Array        *fields;
+    SQLUSMALLINT        *rowstats;
+    SQLULEN             arrsz;
+    SQLULEN             fetched;
+    SQLULEN             current;
+    SQLULEN             row;        // index of current row in block
+    uint64_t            rowseq;
+    CMBool              isend;
+    CMBool              failed;     // ended by fetch error
+} CMDBM_ODBC_Cursor;
+
+CMDBM_STATIC void CMDBM_ODBC_CloseCursor(void *cursor)
+{
+    CMDBM_ODBC_Cursor *csr = (CMDBM_ODBC_Cursor*)cursor;
+    if (csr) {
+        if (csr->stmt)
+            SQLFreeHandle(SQL_HANDLE_STMT, csr->stmt);
+        if (csr->fields)
+            CMCall(csr->fields, Destroy);
+        if (csr->rowstats)
+            CMFree(csr->rowstats);
+        CMFree(csr);
+    }
+}
+
+CMDBM_STATIC CMDBM_ODBC_Cursor *CMDBM_ODBC_CursorCreate(
+        CMDBM_ODBCSession *sess, CMUTIL_String *query,
+        CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs, uint32_t arrsz)
+{
+    CMDBM_ODBC_Cursor *res = CMAlloc(sizeof(CMDBM_ODBC_Cursor));
+    memset(res, 0x0, sizeof(CMDBM_ODBC_Cursor));
+    res->sess = sess;
+    res->arrsz = arrsz > 0? arrsz:1;
+    res->fields = CMUTIL_ArrayCreateEx(10, NULL, CMDBM_ODBC_BindFieldDestroy);
+    res->stmt = CMDBM_ODBC_SelectBase(
+                sess, query, binds, outs, res->fields, &res->arrsz);
+    if (res->stmt == NULL)
+        goto FAILED;
+
+    if (res->arrsz > 1) {
+        res->rowstats = CMAlloc(sizeof(SQLUSMALLINT) * res->arrsz);
+        TRYODBC(res->stmt, SQL_HANDLE_STMT, SQLSetStmtAttr(
+                    res->stmt, SQL_ATTR_ROW_BIND_TYPE,
+                    (SQLPOINTER)SQL_BIND_BY_COLUMN, 0));
+        TRYODBC(res->stmt, SQL_HANDLE_STMT, SQLSetStmtAttr(
+                    res->stmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                    (SQLPOINTER)res->arrsz, 0));
+        TRYODBC(res->stmt, SQL_HANDLE_STMT, SQLSetStmtAttr(
+                    res->stmt, SQL_ATTR_ROW_STATUS_PTR, res->rowstats, 0));
+        TRYODBC(res->stmt, SQL_HANDLE_STMT, SQLSetStmtAttr(
+                    res->stmt, SQL_ATTR_ROWS_FETCHED_PTR, &res->fetched, 0));
+    }
+    return res;
+FAILED:
+    CMDBM_ODBC_CloseCursor(res);
+    return NULL;
+}
+
+CMDBM_STATIC CMBool CMDBM_ODBC_NextRow(CMDBM_ODBC_Cursor *csr)
+{
+    while (CMTrue) {
+        if (csr->current >= csr->fetched) {
+            SQLRETURN sr;
+            if (csr->isend)
+                return CMFalse;
+            sr = SQLFetch(csr->stmt);
+            if (sr == SQL_NO_DATA_FOUND) {
+                csr->isend = CMTrue;
+                return CMFalse;
+            }
+            TRYODBC(csr->stmt, SQL_HANDLE_STMT, sr);
+            // rows fetched pointer is only set up for block cursors.
+            if (csr->arrsz == 1)
+                csr->fetched = 1;
+            csr->current = 0;
+            if (csr->fetched == 0)
+                continue;
+        }
+        if (csr->rowstats == NULL ||
+                csr->rowstats[csr->current] != SQL_ROW_NOROW) {
+            if (csr->rowstats &&
+                    csr->rowstats[csr->current] == SQL_ROW_ERROR) {
+                // dropping the row would return incomplete result.
+                CMLogError("row %lu of result has error.",
+                           (unsigned long)csr->rowseq);
+                goto FAILED;
+            }
+            break;
+        }
+        csr->current++;
+    }
+    csr->row = csr->current++;
+    csr->rowseq++;
+    return CMTrue;
+FAILED:
+    csr->isend = CMTrue;
+    csr->failed = CMTrue;
+    csr->fetched = csr->current = 0;
+    return CMFalse;
+}
+
+CMDBM_STATIC CMUTIL_JsonObject *CMDBM_ODBC_FetchRow(CMDBM_ODBC_Cursor *csr)
 {
     SQLUSMALLINT i;
-    size_t numfields = CMCall(finfos, GetSize);
+    size_t numfields = CMCall(csr->fields, GetSize);
+    CMUTIL_JsonObject *res = NULL;
+
+    if (!CMDBM_ODBC_NextRow(csr))
+        return NULL;
+    res = CMUTIL_JsonObjectCreate();
     for (i=0; i<numfields; i++) {
         CMDBM_ODBC_BindField *finfo =
-                (CMDBM_ODBC_BindField*)CMCall(finfos, GetAt, i);
-        if (finfo->outLen == SQL_NULL_DATA) {
-            CMCall(row, PutNull, finfo->name);
+                (CMDBM_ODBC_BindField*)CMCall(csr->fields, GetAt, i);
+        if (finfo->lens && finfo->lens[csr->row] == SQL_NULL_DATA) {
+            CMCall(res, PutNull, finfo->name);
         } else {
-            finfo->fassign(finfo, stmt, row, i+1);
+            finfo->fassign(finfo, csr->stmt, res, i+1, csr->row);
         }
     }
+    return res;
+}
+
+CMDBM_STATIC uint32_t CMDBM_ODBC_FetchSize(CMDBM_ODBCSession *sess)
+{
+    return sess->fetchsize > 0? sess->fetchsize:CMDBM_ODBC_FETCH_ROWS;
 }
 
 CMDBM_STATIC CMUTIL_JsonObject *CMDBM_ODBC_GetRow(
@@ -678,30 +1028,13 @@ CMDBM_STATIC CMUTIL_JsonObject *CMDBM_ODBC_GetRow(
         CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
 {
     CMDBM_ODBCSession *sess = (CMDBM_ODBCSession*)connection;
-    CMUTIL_Array *fields = CMUTIL_ArrayCreateEx(
-                10, NULL, CMDBM_ODBC_BindFieldDestroy);
-    SQLHSTMT stmt = CMDBM_ODBC_SelectBase(sess, query, binds, outs, fields);
     CMUTIL_JsonObject *res = NULL;
-    CMBool succ = CMFalse;
-
-    if (stmt) {
-        TRYODBC(stmt, SQL_HANDLE_STMT, SQLFetch(stmt));
-        res = CMUTIL_JsonObjectCreate();
-        CMUTIL_ODBC_RowSetFields(fields, stmt, res);
-    } else {
-        goto FAILED;
-    }
+    CMDBM_ODBC_Cursor *csr =
+            CMDBM_ODBC_CursorCreate(sess, query, binds, outs, 1);
 
-    succ = CMTrue;
-FAILED:
-    if (stmt) {
-        SQLFreeHandle(SQL_HANDLE_STMT, stmt);
-    }
-    if (fields)
-        CMCall(fields, Destroy);
-    if (!succ && res) {
-        CMUTIL_JsonDestroy(res);
-        res = NULL;
+    if (csr) {
+        res = CMDBM_ODBC_FetchRow(csr);
+        CMDBM_ODBC_CloseCursor(csr);
     }
     CMUTIL_UNUSED(initres);
     return res;
@@ -734,47 +1067,32 @@ CMDBM_STATIC CMUTIL_JsonArray *CMDBM_ODBC_GetList(
         CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
 {
     CMDBM_ODBCSession *sess = (CMDBM_ODBCSession*)connection;
-    CMUTIL_Array *fields = CMUTIL_ArrayCreateEx(
-                10, NULL, CMDBM_ODBC_BindFieldDestroy);
-    SQLHSTMT stmt = CMDBM_ODBC_SelectBase(sess, query, binds, outs, fields);
-    CMUTIL_JsonArray *res = CMUTIL_JsonArrayCreate();
-    CMBool succ = CMFalse;
+    CMUTIL_JsonObject *row = NULL;
+    CMUTIL_JsonArray *res = NULL;
+    CMDBM_ODBC_Cursor *csr = CMDBM_ODBC_CursorCreate(
+                sess, query, binds, outs, CMDBM_ODBC_FetchSize(sess));
 
-    if (stmt) {
-        int rcnt = 0;
-        SQLRETURN sr = SQL_SUCCESS;
-        while ((sr = SQLFetch(stmt)) == SQL_SUCCESS) {
-            CMUTIL_JsonObject *obj = CMUTIL_JsonObjectCreate();
-            CMUTIL_ODBC_RowSetFields(fields, stmt,  obj);
-            CMCall(res, Add, (CMUTIL_Json*)obj);
-            rcnt++;
+    if (csr) {
+        res = CMUTIL_JsonArrayCreate();
+        while ((row = CMDBM_ODBC_FetchRow(csr)) != NULL)
+            CMCall(res, Add, (CMUTIL_Json*)row);
+        if (csr->failed) {
+            CMUTIL_JsonDestroy(res);
+            res = NULL;
         }
-        if (sr == SQL_ERROR)
-            TRYODBC(stmt, SQL_HANDLE_STMT, sr);
-    } else {
-        goto FAILED;
-    }
-
-    succ = CMTrue;
-FAILED:
-    if (stmt)
-        SQLFreeHandle(SQL_HANDLE_STMT, stmt);
-    if (fields)
-        CMCall(fields, Destroy);
-    if (!succ && res) {
-        CMUTIL_JsonDestroy(res);
-        res = NULL;
+        CMDBM_ODBC_CloseCursor(csr);
     }
     CMUTIL_UNUSED(initres);
     return res;
 }
 
-CMDBM_STATIC int CMDBM_ODBC_Execute(
+CMDBM_STATIC int CMDBM_ODBC_ExecuteLob(
         void *initres, void *connection,
-        CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
+        CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs,
+        CMDBM_LobSource **lobs)
 {
     CMDBM_ODBCSession *sess = (CMDBM_ODBCSession*)connection;
-    SQLHSTMT stmt = CMDBM_ODBC_ExecuteBase(sess, query, binds, outs);
+    SQLHSTMT stmt = CMDBM_ODBC_ExecuteBase(sess, query, binds, outs, lobs);
     if (stmt) {
         SQLLEN rcnt = 0;
         TRYODBC(stmt, SQL_HANDLE_STMT, SQLRowCount(stmt, &rcnt));
@@ -788,61 +1106,206 @@ FAILED:
     return -1;
 }
 
-typedef struct CMDBM_ODBC_Cursor {
-    CMDBM_ODBCSession	*sess;
-    SQLHSTMT			stmt;
-    CMUTIL_Array		*fields;
-} CMDBM_ODBC_Cursor;
+CMDBM_STATIC int CMDBM_ODBC_Execute(
+        void *initres, void *connection,
+        CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
+{
+    return CMDBM_ODBC_ExecuteLob(initres, connection, query, binds, outs, NULL);
+}
 
 CMDBM_STATIC void *CMDBM_ODBC_OpenCursor(
         void *initres, void *connection,
         CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
 {
     CMDBM_ODBCSession *sess = (CMDBM_ODBCSession*)connection;
-    CMUTIL_Array *fields = CMUTIL_ArrayCreateEx(
-                10, NULL, CMDBM_ODBC_BindFieldDestroy);
-    SQLHSTMT stmt = CMDBM_ODBC_SelectBase(sess, query, binds, outs, fields);
-    if (stmt) {
-        CMDBM_ODBC_Cursor *res = CMAlloc(sizeof(CMDBM_ODBC_Cursor));
-        memset(res, 0x0, sizeof(CMDBM_ODBC_Cursor));
-        res->sess = sess;
-        res->stmt = stmt;
-        res->fields = fields;
-        return res;
-    }
-    if (stmt)
-        SQLFreeHandle(SQL_HANDLE_STMT, stmt);
-    if (fields)
-        CMCall(fields, Destroy);
     CMUTIL_UNUSED(initres);
+    return CMDBM_ODBC_CursorCreate(
+                sess, query, binds, outs, CMDBM_ODBC_FetchSize(sess));
+}
+
+CMDBM_STATIC CMUTIL_JsonObject *CMDBM_ODBC_CursorNextRow(void *cursor)
+{
+    CMDBM_ODBC_Cursor *csr = (CMDBM_ODBC_Cursor*)cursor;
+    if (csr)
+        return CMDBM_ODBC_FetchRow(csr);
     return NULL;
 }
 
-CMDBM_STATIC void CMDBM_ODBC_CloseCursor(void *cursor)
+CMDBM_STATIC CMBool CMDBM_ODBC_CursorFetch(void *cursor)
 {
     CMDBM_ODBC_Cursor *csr = (CMDBM_ODBC_Cursor*)cursor;
-    if (csr) {
-        if (csr->fields) CMCall(csr->fields, Destroy);
-        if (csr->stmt)
-            SQLFreeHandle(SQL_HANDLE_STMT, csr->stmt);
-        if (csr->fields)
-            CMCall(csr->fields, Destroy);
-        CMFree(csr);
+    return csr? CMDBM_ODBC_NextRow(csr):CMFalse;
+}
+
+CMDBM_STATIC CMBool CMDBM_ODBC_CursorFailed(void *cursor)
+{
+    CMDBM_ODBC_Cursor *csr = (CMDBM_ODBC_Cursor*)cursor;
+    return csr? csr->failed:CMFalse;
+}
+
+CMDBM_STATIC uint32_t CMDBM_ODBC_CursorColumnCount(void *cursor)
+{
+    CMDBM_ODBC_Cursor *csr = (CMDBM_ODBC_Cursor*)cursor;
+    return (uint32_t)CMCall(csr->fields, GetSize);
+}
+
+CMDBM_STATIC const char *CMDBM_ODBC_CursorColumnName(
+        void *cursor, uint32_t index)
+{
+    CMDBM_ODBC_Cursor *csr = (CMDBM_ODBC_Cursor*)cursor;
+    CMDBM_ODBC_BindField *finfo =
+            (CMDBM_ODBC_BindField*)CMCall(csr->fields, GetAt, index);
+    return finfo? finfo->name:NULL;
+}
+
+CMDBM_STATIC CMJsonValueType CMDBM_ODBC_CursorColumnType(
+        void *cursor, uint32_t index)
+{
+    CMDBM_ODBC_Cursor *csr = (CMDBM_ODBC_Cursor*)cursor;
+    CMDBM_ODBC_BindField *finfo =
+            (CMDBM_ODBC_BindField*)CMCall(csr->fields, GetAt, index);
+    return finfo? finfo->jtype:CMJsonValueNull;
+}
+
+CMDBM_STATIC CMBool CMDBM_ODBC_CursorGetValue(
+        void *cursor, uint32_t index, CMDBM_ColumnValue *value)
+{
+    CMDBM_ODBC_Cursor *csr = (CMDBM_ODBC_Cursor*)cursor;
+    CMDBM_ODBC_BindField *finfo =
+            (CMDBM_ODBC_BindField*)CMCall(csr->fields, GetAt, index);
+    if (finfo == NULL)
+        return CMFalse;
+    value->length = 0;
+    if (finfo->values == NULL) {
+        // SQLGetData can be called only once per column and row.
+        if (finfo->getseq != csr->rowseq) {
+            if (!CMDBM_ODBC_GetDataString(
+                        finfo, csr->stmt, (SQLUSMALLINT)(index+1)))
+                return CMFalse;
+            finfo->getseq = csr->rowseq;
+        } else if (finfo->outLen == SQL_NO_TOTAL) {
+            CMLogError("column %u is already streamed by lob reader.", index);
+            return CMFalse;
+        }
+        if (finfo->outLen == SQL_NULL_DATA) {
+            value->type = CMJsonValueNull;
+        } else {
+            value->type = CMJsonValueString;
+            value->u.sval = finfo->getbuf;
+            value->length = (size_t)finfo->outLen;
+        }
+        return CMTrue;
+    }
+    if (finfo->lens[csr->row] == SQL_NULL_DATA) {
+        value->type = CMJsonValueNull;
+        return CMTrue;
     }
+    value->type = finfo->jtype;
+    if (finfo->kind == CMDBM_ValueTimestamp) {
+        CMDBM_DateTime dt;
+        CMDBM_ODBC_GetDateTime(finfo, csr->row, &dt);
+        CMDBM_DateTimeToValue(&dt, finfo->textbuf, value);
+        return CMTrue;
+    } else if (finfo->kind == CMDBM_ValueDecimal) {
+        const char *text = finfo->values + (finfo->width * (SQLLEN)csr->row);
+        value->u.dval = strtod(text, NULL);
+        CMDBM_DecimalToValue(text, strlen(text), finfo->scale, value);
+        return CMTrue;
+    } else if (finfo->kind == CMDBM_ValueBinary) {
+        value->u.sval = CMDBM_ODBC_BinaryHex(
+                    finfo, csr->row, &(value->length));
+        value->kind = CMDBM_ValueBinary;
+        value->native.bin.data =
+                finfo->values + (finfo->width * (SQLLEN)csr->row);
+        value->native.bin.length = (size_t)finfo->lens[csr->row];
+        return CMTrue;
+    }
+    switch (finfo->jtype) {
+    case CMJsonValueLong:
+        value->u.lval = ((int64_t*)finfo->values)[csr->row];
+        break;
+    case CMJsonValueDouble:
+        value->u.dval = ((double*)finfo->values)[csr->row];
+        break;
+    case CMJsonValueBoolean:
+        value->u.bval = ((short*)finfo->values)[csr->row]? CMTrue:CMFalse;
+        break;
+    default:
+        value->u.sval = finfo->values + (finfo->width * (SQLLEN)csr->row);
+        value->length = strlen(value->u.sval);
+    }
+    return CMTrue;
 }
 
-CMDBM_STATIC CMUTIL_JsonObject *CMDBM_ODBC_CursorNextRow(void *cursor)
+CMDBM_STATIC int64_t CMDBM_ODBC_CursorReadLob(
+        void *cursor, uint32_t index, CMBool restart, void *buf, size_t size)
 {
     CMDBM_ODBC_Cursor *csr = (CMDBM_ODBC_Cursor*)cursor;
-    if (csr) {
-        CMUTIL_JsonObject *res = NULL;
-        TRYODBC(csr->stmt, SQL_HANDLE_STMT, SQLFetch(csr->stmt));
-        res = CMUTIL_JsonObjectCreate();
-        CMUTIL_ODBC_RowSetFields(csr->fields, csr->stmt, res);
-        return res;
+    CMDBM_ODBC_BindField *finfo =
+            (CMDBM_ODBC_BindField*)CMCall(csr->fields, GetAt, index);
+    const char *data = NULL;
+    size_t len = 0, n;
+    if (finfo == NULL || finfo->jtype != CMJsonValueString ||
+            finfo->kind == CMDBM_ValueTimestamp) {
+        CMLogError("column %u is not character or binary column.", index);
+        return -1;
     }
-    FAILED:
-    return NULL;
+    if (restart)
+        finfo->lobpos = 0;
+    if (finfo->values) {
+        // bound column, value is already in fetch buffer.
+        if (finfo->lens[csr->row] == SQL_NULL_DATA)
+            return 0;
+        data = finfo->values + (finfo->width * (SQLLEN)csr->row);
+        len = finfo->kind == CMDBM_ValueBinary?
+                    (size_t)finfo->lens[csr->row]:strlen(data);
+    } else {
+        if (restart && finfo->getseq != csr->rowseq) {
+            // streamed with SQLGetData, value is not kept in 'getbuf'.
+            finfo->getseq = csr->rowseq;
+            finfo->outLen = SQL_NO_TOTAL;
+        }
+        if (finfo->outLen == SQL_NO_TOTAL) {
+            SQLLEN ind = 0;
+            SQLRETURN sr = SQLGetData(
+                        csr->stmt, (SQLUSMALLINT)(index+1), SQL_C_BINARY,
+                        buf, (SQLLEN)size, &ind);
+            if (sr == SQL_NO_DATA_FOUND)
+                return 0;
+            TRYODBC(csr->stmt, SQL_HANDLE_STMT, sr);
+            if (ind == SQL_NULL_DATA) {
+                finfo->outLen = SQL_NULL_DATA;
+                return 0;
+            }
+            // truncated piece fills whole buffer.
+            if (ind == SQL_NO_TOTAL || ind > (SQLLEN)size)
+                return (int64_t)size;
+            return (int64_t)ind;
+        }
+        // already read into 'getbuf' by GetValue.
+        if (finfo->outLen == SQL_NULL_DATA)
+            return 0;
+        data = finfo->getbuf;
+        len = (size_t)finfo->outLen;
+    }
+    if (finfo->lobpos >= len)
+        return 0;
+    n = len - finfo->lobpos;
+    if (n > size)
+        n = size;
+    memcpy(buf, data + finfo->lobpos, n);
+    finfo->lobpos += n;
+    return (int64_t)n;
+FAILED:
+    return -1;
+}
+
+CMDBM_STATIC void CMDBM_ODBC_SetFetchSize(
+        void *initres, void *connection, uint32_t rows)
+{
+    CMDBM_ODBCSession *sess = (CMDBM_ODBCSession*)connection;
+    sess->fetchsize = rows;
+    CMUTIL_UNUSED(initres);
 }
 
 CMDBM_STATIC void CMDBM_ODBC_LibraryInit()
@@ -873,7 +1336,19 @@ CMDBM_ModuleInterface g_cmdbm_odbc_interface = {
     CMDBM_ODBC_Execute,
     CMDBM_ODBC_OpenCursor,
     CMDBM_ODBC_CloseCursor,
-    CMDBM_ODBC_CursorNextRow
+    CMDBM_ODBC_CursorNextRow,
+    NULL, NULL,
+    CMDBM_ODBC_SetFetchSize,
+    CMDBM_ODBC_CursorColumnCount,
+    CMDBM_ODBC_CursorColumnName,
+    CMDBM_ODBC_CursorFetch,
+    CMDBM_ODBC_CursorGetValue,
+    CMDBM_ODBC_CursorColumnType,
+    CMDBM_ODBC_CursorReadLob,
+    CMDBM_ODBC_ExecuteLob,
+    CMDBM_ODBC_PingConnection,
+    NULL, NULL,
+    CMDBM_ODBC_CursorFailed
 };
 
 #endif
@@ -5,6 +5,9 @@
 
 CMUTIL_LogDefine("cmdbm.module.oracle")
 
+// rows per OCIStmtFetch2 call when fetch size is not given.
+#define CMDBM_ORACLE_FETCH_ROWS     100
+
 #define __BORLANDC__
 #include <oci.h>
 
@@ -34,7 +37,7 @@ typedef struct CMDBM_OracleSession {
     OCISvcCtx       *svchp;
     OCISession      *authp;
     CMBool          autocommit;
-    int             dummy_padder;
+    uint32_t        fetchsize;
 } CMDBM_OracleSession;
 
 #define CMDBM_OracleCheck(c,s,b,a,...) do {\
@@ -86,7 +89,7 @@ typedef struct CMDBM_OracleSession {
         CMLogError("OCI returned OCI_CONTINUE");\
         goto b;\
     default:\
-        CMLogError("OCI returned unknown error: %d", status);\
+        CMLogError("OCI returned unknown error: %d", s);\
         goto b;\
     }\
 } while(0)
@@ -115,7 +118,7 @@ CMDBM_STATIC void *CMDBM_Oracle_Initialize(const char *dbcs, const char *prcs)
             res->convmtx = CMUTIL_MutexCreate();
         }
     }
-    return env;
+    return res;
 }
 
 CMDBM_STATIC void CMDBM_Oracle_CleanUp(void *initres)
@@ -163,6 +166,15 @@ CMDBM_STATIC void CMDBM_Oracle_CloseConnection(
     CMUTIL_UNUSED(initres);
 }
 
+CMDBM_STATIC CMBool CMDBM_Oracle_PingConnection(
+        void *initres, void *connection)
+{
+    CMDBM_OracleSession *conn = (CMDBM_OracleSession*)connection;
+    CMUTIL_UNUSED(initres);
+    return OCIPing(conn->svchp, conn->errhp, OCI_DEFAULT) == OCI_SUCCESS?
+                CMTrue:CMFalse;
+}
+
 CMDBM_STATIC void *CMDBM_Oracle_OpenConnection(
         void *initres, CMUTIL_JsonObject *params)
 {
@@ -189,6 +201,7 @@ CMDBM_STATIC void *CMDBM_Oracle_OpenConnection(
     memset(res, 0x0, sizeof(CMDBM_OracleSession));
     res->envhp = ctx->envhp;
     res->ctx = ctx;
+    res->autocommit = CMTrue;
     if (OCIHandleAlloc(res->envhp, (void**)&(res->errhp),
                        OCI_HTYPE_ERROR, 0, NULL) != OCI_SUCCESS) {
         CMLogError("OCI error context allocation failed.");
@@ -232,19 +245,12 @@ CMDBM_STATIC CMBool CMDBM_Oracle_StartTransaction(
         void *initres, void *connection)
 {
     CMDBM_OracleSession *conn = (CMDBM_OracleSession*)connection;
+    // transaction starts implicitly with the next statement.
     conn->autocommit = CMFalse;
     CMUTIL_UNUSED(initres);
     return CMTrue;
 }
 
-CMDBM_STATIC void CMDBM_Oracle_EndTransaction(
-        void *initres, void *connection)
-{
-    CMDBM_OracleSession *conn = (CMDBM_OracleSession*)connection;
-    conn->autocommit = CMTrue;
-    CMUTIL_UNUSED(initres);
-}
-
 CMDBM_STATIC CMBool CMDBM_Oracle_CommitTransaction(
         void *initres, void *connection)
 {
@@ -270,13 +276,34 @@ ENDPOINT:
     CMUTIL_UNUSED(initres);
 }
 
+CMDBM_STATIC void CMDBM_Oracle_EndTransaction(
+        void *initres, void *connection)
+{
+    CMDBM_OracleSession *conn = (CMDBM_OracleSession*)connection;
+    // open transaction must not reach next user of connection.
+    CMDBM_Oracle_RollbackTransaction(initres, connection);
+    conn->autocommit = CMTrue;
+}
+
 typedef struct CMDBM_OracleColumn {
     char        *name;
     void        *buffer;
     OCIDefine   *define;
+    sb2         *indicators;
+    ub2         *lengths;
+    char        *hexbuf;    // hex text of binary value
+    size_t      hexcap;
+    char        *lobbuf;    // whole lob value for json rows
+    size_t      lobcap;
+    oraub8      lobpos;     // 1-based read offset of lob reader
     uint32_t    index;
     uint32_t    bufsz;
+    uint32_t    arrsz;
+    ub4         dtype;      // descriptor type of datetime, lob buffers
     int         indicator;
+    int         scale;
+    CMDBM_ValueKind kind;
+    char        textbuf[CMDBM_DATETIME_BUFSZ];
     ub2         typecd;
     short       dummy_padder;
 } CMDBM_OracleColumn;
@@ -434,9 +461,10 @@ static CMDBM_Oracle_BindProc g_cmdbm_oracle_bindprocs[]={
     CMDBM_Oracle_BindNull
 };
 
-CMDBM_STATIC void CMDBM_Oracle_AllocBuffer(
-        CMDBM_OracleColumn *col)
+CMDBM_STATIC CMBool CMDBM_Oracle_AllocBuffer(
+        CMDBM_OracleSession *conn, CMDBM_OracleColumn *col, uint32_t arrsz)
 {
+    uint32_t i;
     switch (col->typecd) {
     case SQLT_INT:
     case SQLT_UIN:
@@ -449,18 +477,65 @@ CMDBM_STATIC void CMDBM_Oracle_AllocBuffer(
         col->bufsz = (int)sizeof(double);
         col->typecd = SQLT_FLT;
         break;
+    case SQLT_DAT:
+    case SQLT_DATE:
+    case SQLT_TIMESTAMP:
+        // datetime descriptors, formatted for json rows
+        col->bufsz = (int)sizeof(OCIDateTime*);
+        col->typecd = SQLT_TIMESTAMP;
+        col->dtype = OCI_DTYPE_TIMESTAMP;
+        col->kind = CMDBM_ValueTimestamp;
+        break;
+    case SQLT_TIMESTAMP_TZ:
+    case SQLT_TIMESTAMP_LTZ:
+        col->bufsz = (int)sizeof(OCIDateTime*);
+        col->typecd = SQLT_TIMESTAMP_TZ;
+        col->dtype = OCI_DTYPE_TIMESTAMP_TZ;
+        col->kind = CMDBM_ValueTimestamp;
+        break;
+    case SQLT_NUM:
+    case SQLT_VNU:
+        // exact decimal text, fits 40 digits with sign and exponent.
+        col->bufsz = 64;
+        col->typecd = SQLT_STR;
+        col->kind = CMDBM_ValueDecimal;
+        break;
+    case SQLT_BIN:
+        // raw bytes, hex encoded for json rows
+        col->bufsz = 4000;
+        col->typecd = SQLT_BIN;
+        col->kind = CMDBM_ValueBinary;
+        break;
     case SQLT_CLOB:
     case SQLT_BLOB:
-        // treat as string
-        col->bufsz = 9999;
-        col->typecd = SQLT_STR;
+        // lob locators, values are read in pieces.
+        col->bufsz = (int)sizeof(OCILobLocator*);
+        col->dtype = OCI_DTYPE_LOB;
+        if (col->typecd == SQLT_BLOB)
+            col->kind = CMDBM_ValueBinary;
         break;
     default:
         // treat as string
         col->bufsz = 4000;
         col->typecd = SQLT_STR;
     }
-    col->buffer = CMAlloc(col->bufsz);
+    // column-wise arrays, one slot per row of a fetch.
+    col->arrsz = arrsz;
+    col->buffer = CMAlloc(col->bufsz * arrsz);
+    col->indicators = CMAlloc(sizeof(sb2) * arrsz);
+    col->lengths = CMAlloc(sizeof(ub2) * arrsz);
+    if (col->dtype != 0) {
+        memset(col->buffer, 0x0, col->bufsz * arrsz);
+        for (i=0; i<arrsz; i++) {
+            if (OCIDescriptorAlloc(conn->envhp,
+                                   &(((void**)col->buffer)[i]),
+                                   col->dtype, 0, NULL) != OCI_SUCCESS) {
+                CMLogError("cannot allocate column descriptor.");
+                return CMFalse;
+            }
+        }
+    }
+    return CMTrue;
 }
 
 CMDBM_STATIC void CMDBM_OracleColumnDestroy(void *data)
@@ -468,7 +543,20 @@ CMDBM_STATIC void CMDBM_OracleColumnDestroy(void *data)
     CMDBM_OracleColumn *col = (CMDBM_OracleColumn*)data;
     if (col) {
         if (col->define) OCIHandleFree(col->define, OCI_HTYPE_DEFINE);
-        if (col->buffer) CMFree(col->buffer);
+        if (col->buffer) {
+            if (col->dtype != 0) {
+                uint32_t i;
+                for (i=0; i<col->arrsz; i++)
+                    if (((void**)col->buffer)[i])
+                        OCIDescriptorFree(
+                                    ((void**)col->buffer)[i], col->dtype);
+            }
+            CMFree(col->buffer);
+        }
+        if (col->hexbuf) CMFree(col->hexbuf);
+        if (col->lobbuf) CMFree(col->lobbuf);
+        if (col->indicators) CMFree(col->indicators);
+        if (col->lengths) CMFree(col->lengths);
         if (col->name  ) CMFree(col->name);
         CMFree(col);
     }
@@ -501,16 +589,68 @@ CMDBM_STATIC void CMDBM_Oracle_SetOutValue(
     }
 }
 
+// copies lob source into a session temporary lob.
+CMDBM_STATIC CMBool CMDBM_Oracle_WriteLob(
+        CMDBM_OracleSession *conn, CMDBM_LobSource *lob, OCILobLocator *loc)
+{
+    sb4 status;
+    CMBool succ = CMFalse;
+    oraub8 offset = 1;
+    int64_t n, next;
+    ub1 piece = OCI_FIRST_PIECE;
+    char *chunk = CMAlloc(CMDBM_LOB_CHUNK * 2);
+    char *cur = chunk, *ahead = chunk + CMDBM_LOB_CHUNK, *temp;
+
+    CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCILobCreateTemporary,
+                      conn->svchp, conn->errhp, loc, 0, SQLCS_IMPLICIT,
+                      lob->binary? OCI_TEMP_BLOB:OCI_TEMP_CLOB,
+                      FALSE, OCI_DURATION_SESSION);
+    // one chunk is read ahead to know which piece is the last one.
+    n = lob->read(cur, CMDBM_LOB_CHUNK, lob->udata);
+    while (n > 0) {
+        oraub8 bytes = 0, chars = 0;
+        next = lob->read(ahead, CMDBM_LOB_CHUNK, lob->udata);
+        if (next < 0) {
+            n = next;
+            break;
+        }
+        if (next == 0) {
+            piece = piece == OCI_FIRST_PIECE? OCI_ONE_PIECE:OCI_LAST_PIECE;
+            if (piece == OCI_ONE_PIECE)
+                bytes = (oraub8)n;
+        }
+        CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCILobWrite2,
+                          conn->svchp, conn->errhp, loc, &bytes, &chars,
+                          offset, cur, (oraub8)n, piece,
+                          NULL, NULL, 0, SQLCS_IMPLICIT);
+        piece = OCI_NEXT_PIECE;
+        temp = cur; cur = ahead; ahead = temp;
+        n = next;
+    }
+    if (n < 0) {
+        CMLogError("reading lob source '%s' failed.", lob->name);
+        goto FAILEDPOINT;
+    }
+    succ = CMTrue;
+FAILEDPOINT:
+    CMFree(chunk);
+    return succ;
+}
+
 CMDBM_STATIC OCIStmt *CMDBM_Oracle_ExecuteBase(
         CMDBM_OracleSession *conn, CMUTIL_String *query,
-        CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
+        CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs, ub4 prefetch,
+        CMDBM_LobSource **lobs)
 {
     uint32_t i;
     size_t bsize = 0;
     sb4 status;
+    ub2 stmttype = 0;
+    ub4 iters = 1, mode = OCI_DEFAULT;
     CMBool succ = CMFalse;
     OCIStmt *stmt = NULL;
     OCIBind **buffers = NULL;
+    OCILobLocator **locs = NULL;
     CMUTIL_Array *array = CMUTIL_ArrayCreateEx(
                 CMCall(binds, GetSize), NULL, CMFree);
     CMUTIL_Array *outarr = CMUTIL_ArrayCreateEx(
@@ -527,11 +667,27 @@ CMDBM_STATIC OCIStmt *CMDBM_Oracle_ExecuteBase(
     bsize = CMCall(binds, GetSize);
     buffers = CMAlloc(sizeof(OCIBind*) * bsize);
     memset(buffers, 0x0, sizeof(OCIBind*) * bsize);
+    if (lobs) {
+        locs = CMAlloc(sizeof(OCILobLocator*) * bsize);
+        memset(locs, 0x0, sizeof(OCILobLocator*) * bsize);
+    }
     for (i=0; i<bsize; i++) {
         char ibuf[20];
         CMUTIL_Json *json = CMCall(binds, Get, i);
         sprintf(ibuf, "%d", i);
-        if (CMCall(json, GetType) == CMJsonTypeValue) {
+        if (lobs && lobs[i]) {
+            // lob values are written to temporary lobs and bound by locator.
+            CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIDescriptorAlloc,
+                              conn->envhp, (void**)&locs[i],
+                              OCI_DTYPE_LOB, 0, NULL);
+            if (!CMDBM_Oracle_WriteLob(conn, lobs[i], locs[i]))
+                goto FAILEDPOINT;
+            CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIBindByPos,
+                              stmt, &buffers[i], conn->errhp, i+1,
+                              &locs[i], (sb4)sizeof(OCILobLocator*),
+                              lobs[i]->binary? SQLT_BLOB:SQLT_CLOB,
+                              0,0,0,0,0,OCI_DEFAULT);
+        } else if (CMCall(json, GetType) == CMJsonTypeValue) {
             CMUTIL_JsonValue *jval = (CMUTIL_JsonValue*)json;
             CMUTIL_Json *out = CMCall(outs, Get, ibuf);
             // type of json value
@@ -547,9 +703,26 @@ CMDBM_STATIC OCIStmt *CMDBM_Oracle_ExecuteBase(
         }
     }
 
+    // select statements must be executed with zero iterations,
+    // rows are retrieved by subsequent fetch calls.
+    CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIAttrGet,
+                      stmt, OCI_HTYPE_STMT, &stmttype, 0,
+                      OCI_ATTR_STMT_TYPE, conn->errhp);
+    if (stmttype == OCI_STMT_SELECT) {
+        iters = 0;
+        if (prefetch > 0)
+            CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIAttrSet,
+                              stmt, OCI_HTYPE_STMT, &prefetch, 0,
+                              OCI_ATTR_PREFETCH_ROWS, conn->errhp);
+    } else if (conn->autocommit) {
+        // outside of transaction, commit is sent with execution itself.
+        mode = OCI_COMMIT_ON_SUCCESS;
+    }
+
     // execute statement
     CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIStmtExecute,
-                      conn->svchp, stmt, conn->errhp, 1, 0,0,0, OCI_DEFAULT);
+                      conn->svchp, stmt, conn->errhp, iters, 0,0,0,
+                      mode);
 
     // retreive out variables
     {
@@ -579,6 +752,16 @@ FAILEDPOINT:
             if (buffers[i]) OCIHandleFree(buffers[i], OCI_HTYPE_BIND);
         CMFree(buffers);
     }
+    if (locs) {
+        for (i=0; i<bsize; i++) {
+            if (locs[i]) {
+                // fails harmlessly if temporary lob was not created.
+                OCILobFreeTemporary(conn->svchp, conn->errhp, locs[i]);
+                OCIDescriptorFree(locs[i], OCI_DTYPE_LOB);
+            }
+        }
+        CMFree(locs);
+    }
 
     if (outarr)
         CMCall(outarr, Destroy);
@@ -590,12 +773,13 @@ FAILEDPOINT:
 CMDBM_STATIC OCIStmt *CMDBM_Oracle_SelectBase(
         CMDBM_OracleSession *conn, CMUTIL_String *query,
         CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs,
-        CMUTIL_Array *outcols)
+        CMUTIL_Array *outcols, uint32_t arrsz)
 {
     CMBool succ = CMFalse;
     ub4 j, colcnt;
     sb4 status;
-    OCIStmt *stmt = CMDBM_Oracle_ExecuteBase(conn, query, binds, outs);
+    OCIStmt *stmt = CMDBM_Oracle_ExecuteBase(
+                conn, query, binds, outs, (ub4)arrsz, NULL);
 
     if (!stmt) goto FAILEDPOINT;
 
@@ -633,18 +817,26 @@ CMDBM_STATIC OCIStmt *CMDBM_Oracle_SelectBase(
         memcpy(column->name, colname, namelen);
         column->name[namelen] = 0x0;
         column->typecd = typecd;
+        CMCall(outcols, Add, column, NULL);
+
+        if (typecd == SQLT_NUM) {
+            sb1 scale = 0;
+            CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIAttrGet,
+                              param, OCI_DTYPE_PARAM, &scale, 0,
+                              OCI_ATTR_SCALE, conn->errhp);
+            column->scale = (int)scale;
+        }
 
         // allocate buffer for result define.
-        CMDBM_Oracle_AllocBuffer(column);
+        if (!CMDBM_Oracle_AllocBuffer(conn, column, arrsz))
+            goto FAILEDPOINT;
 
-        // set define.
+        // set define, arrays are contiguous so default skips apply.
         CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIDefineByPos,
                           stmt, &(column->define), conn->errhp, j+1,
                           column->buffer, (sb4)column->bufsz,
-                          column->typecd, &(column->indicator),
-                          0, 0, OCI_DEFAULT);
-
-        CMCall(outcols, Add, column, NULL);
+                          column->typecd, column->indicators,
+                          column->lengths, 0, OCI_DEFAULT);
     }
     succ = CMTrue;
 FAILEDPOINT:
@@ -655,53 +847,257 @@ FAILEDPOINT:
     return stmt;
 }
 
+typedef struct CMDBM_Oracle_Cursor {
+    CMDBM_OracleSession *conn;
+    OCIStmt             *stmt;
+    CMUTIL_Array        *outcols;
+    uint32_t            arrsz;
+    uint32_t            fetched;
+    uint32_t            current;
+    uint32_t            row;        // index of current row in block
+    CMBool              isend;
+} CMDBM_Oracle_Cursor;
+
+CMDBM_STATIC void CMDBM_Oracle_CloseCursor(void *cursor)
+{
+    CMDBM_Oracle_Cursor *csr = (CMDBM_Oracle_Cursor*)cursor;
+    if (csr) {
+        if (csr->outcols) CMCall(csr->outcols, Destroy);
+        if (csr->stmt) OCIHandleFree(csr->stmt, OCI_HTYPE_STMT);
+        CMFree(csr);
+    }
+}
+
+CMDBM_STATIC CMDBM_Oracle_Cursor *CMDBM_Oracle_CursorCreate(
+        CMDBM_OracleSession *conn, CMUTIL_String *query,
+        CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs, uint32_t arrsz)
+{
+    CMDBM_Oracle_Cursor *res = CMAlloc(sizeof(CMDBM_Oracle_Cursor));
+    memset(res, 0x0, sizeof(CMDBM_Oracle_Cursor));
+    res->conn = conn;
+    res->arrsz = arrsz > 0? arrsz:1;
+    res->outcols = CMUTIL_ArrayCreateEx(
+                10, NULL, CMDBM_OracleColumnDestroy);
+    res->stmt = CMDBM_Oracle_SelectBase(
+                conn, query, binds, outs, res->outcols, res->arrsz);
+    if (res->stmt == NULL) {
+        CMDBM_Oracle_CloseCursor(res);
+        res = NULL;
+    }
+    return res;
+}
+
+CMDBM_STATIC CMBool CMDBM_Oracle_NextRow(
+        CMDBM_Oracle_Cursor *csr)
+{
+    sb4 status;
+    CMDBM_OracleSession *conn = csr->conn;
+
+    if (csr->current >= csr->fetched) {
+        ub4 rows = 0;
+        if (csr->isend)
+            return CMFalse;
+        // fetch next block of rows into column arrays.
+        CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIStmtFetch2,
+                          csr->stmt, conn->errhp, csr->arrsz,
+                          OCI_FETCH_NEXT, 0, OCI_DEFAULT);
+        // last block may be partially filled.
+        if (status == OCI_NO_DATA)
+            csr->isend = CMTrue;
+        CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIAttrGet,
+                          csr->stmt, OCI_HTYPE_STMT, &rows, 0,
+                          OCI_ATTR_ROWS_FETCHED, conn->errhp);
+        csr->fetched = (uint32_t)rows;
+        csr->current = 0;
+        if (rows == 0) {
+            csr->isend = CMTrue;
+            return CMFalse;
+        }
+    }
+    csr->row = csr->current++;
+    return CMTrue;
+FAILEDPOINT:
+    csr->isend = CMTrue;
+    csr->fetched = csr->current = 0;
+    return CMFalse;
+}
+
+CMDBM_STATIC CMBool CMDBM_Oracle_GetDateTime(
+        CMDBM_OracleSession *conn, CMDBM_OracleColumn *col, uint32_t row,
+        CMDBM_DateTime *dt)
+{
+    sb4 status;
+    sb2 year = 0;
+    ub1 month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    ub4 fsec = 0;
+    OCIDateTime *odt = ((OCIDateTime**)col->buffer)[row];
+    memset(dt, 0x0, sizeof(CMDBM_DateTime));
+    CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIDateTimeGetDate,
+                      conn->envhp, conn->errhp, odt, &year, &month, &day);
+    CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIDateTimeGetTime,
+                      conn->envhp, conn->errhp, odt,
+                      &hour, &minute, &second, &fsec);
+    if (col->dtype == OCI_DTYPE_TIMESTAMP_TZ) {
+        sb1 tzhour = 0, tzminute = 0;
+        CMDBM_OracleCheck(conn, status, FAILEDPOINT,
+                          OCIDateTimeGetTimeZoneOffset,
+                          conn->envhp, conn->errhp, odt, &tzhour, &tzminute);
+        dt->tzoffset = tzhour * 60 + tzminute;
+        dt->hastz = CMTrue;
+    }
+    dt->year = year;
+    dt->month = month;
+    dt->day = day;
+    dt->hour = hour;
+    dt->minute = minute;
+    dt->second = second;
+    // fractional seconds are in nanoseconds.
+    dt->usec = (uint32_t)(fsec / 1000);
+    return CMTrue;
+FAILEDPOINT:
+    return CMFalse;
+}
+
+// binary values are given as hex text in json rows.
+CMDBM_STATIC const char *CMDBM_Oracle_BinaryHex(
+        CMDBM_OracleColumn *col, uint32_t row, size_t *length)
+{
+    size_t len = (size_t)col->lengths[row];
+    col->hexbuf = (char*)CMDBM_BufferGrow(
+                col->hexbuf, &col->hexcap, len * 2 + 1, 0);
+    *length = CMDBM_HexEncode(
+                (char*)col->buffer + (col->bufsz * row), len, col->hexbuf);
+    return col->hexbuf;
+}
+
+// reads next piece of lob column, clob offsets are counted in characters.
+CMDBM_STATIC int64_t CMDBM_Oracle_LobRead(
+        CMDBM_OracleSession *conn, CMDBM_OracleColumn *col, uint32_t row,
+        void *buf, size_t size)
+{
+    sb4 status;
+    oraub8 bytes = (oraub8)size, chars = 0;
+    OCILobLocator *loc = ((OCILobLocator**)col->buffer)[row];
+    CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCILobRead2,
+                      conn->svchp, conn->errhp, loc, &bytes, &chars,
+                      col->lobpos, buf, (oraub8)size, OCI_ONE_PIECE,
+                      NULL, NULL, 0, SQLCS_IMPLICIT);
+    if (status == OCI_NO_DATA)
+        return 0;
+    col->lobpos += col->typecd == SQLT_CLOB? chars:bytes;
+    return (int64_t)bytes;
+FAILEDPOINT:
+    return -1;
+}
+
+// whole lob value into 'lobbuf', terminated for clob text.
+CMDBM_STATIC const char *CMDBM_Oracle_LobValue(
+        CMDBM_OracleSession *conn, CMDBM_OracleColumn *col, uint32_t row,
+        size_t *length)
+{
+    size_t len = 0;
+    int64_t n;
+    col->lobpos = 1;
+    do {
+        col->lobbuf = (char*)CMDBM_BufferGrow(
+                    col->lobbuf, &col->lobcap,
+                    len + CMDBM_LOB_CHUNK + 1, len);
+        n = CMDBM_Oracle_LobRead(
+                    conn, col, row, col->lobbuf + len, CMDBM_LOB_CHUNK);
+        if (n < 0)
+            return NULL;
+        len += (size_t)n;
+    } while (n > 0);
+    col->lobbuf[len] = 0x0;
+    *length = len;
+    return col->lobbuf;
+}
+
 CMDBM_STATIC CMUTIL_JsonObject *CMDBM_Oracle_FetchRow(
-        CMDBM_OracleSession *conn, OCIStmt *stmt, CMUTIL_Array *cols)
+        CMDBM_Oracle_Cursor *csr)
 {
     uint32_t i;
-    sb4 status;
     CMUTIL_JsonObject *res = NULL;
-    CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIStmtFetch,
-                      stmt, conn->errhp, 1, OCI_FETCH_NEXT, OCI_DEFAULT);
-    if (status != OCI_NO_DATA && status != OCI_NEED_DATA) {
-        res = CMUTIL_JsonObjectCreate();
-        for (i=0; i<CMCall(cols, GetSize); i++) {
-            CMDBM_OracleColumn *col =
-                    (CMDBM_OracleColumn*)CMCall(cols, GetAt, i);
-            switch(col->typecd) {
-            case SQLT_INT:
-                CMCall(res, PutLong, col->name,
-                            (int64_t)*((int64_t*)col->buffer));
-                break;
-            case SQLT_FLT:
-                CMCall(res, PutDouble, col->name,
-                            (double)*((double*)col->buffer));
-                break;
-            default:
-                CMCall(res, PutString, col->name, col->buffer);
-                // must be reset for next call
-                memset(col->buffer, 0x0, col->bufsz);
+
+    if (!CMDBM_Oracle_NextRow(csr))
+        return NULL;
+    res = CMUTIL_JsonObjectCreate();
+    for (i=0; i<CMCall(csr->outcols, GetSize); i++) {
+        CMDBM_OracleColumn *col =
+                (CMDBM_OracleColumn*)CMCall(csr->outcols, GetAt, i);
+        char *value = (char*)col->buffer + (col->bufsz * csr->row);
+        if (col->indicators[csr->row] == -1) {
+            CMCall(res, PutNull, col->name);
+            continue;
+        }
+        switch(col->typecd) {
+        case SQLT_INT:
+            CMCall(res, PutLong, col->name, *((int64_t*)value));
+            break;
+        case SQLT_FLT:
+            CMCall(res, PutDouble, col->name, *((double*)value));
+            break;
+        case SQLT_TIMESTAMP:
+        case SQLT_TIMESTAMP_TZ: {
+            CMDBM_DateTime dt;
+            if (CMDBM_Oracle_GetDateTime(csr->conn, col, csr->row, &dt)) {
+                CMDBM_DateTimeFormat(&dt, col->textbuf);
+                CMCall(res, PutString, col->name, col->textbuf);
+            } else {
+                CMCall(res, PutNull, col->name);
             }
+            break;
+        }
+        case SQLT_BIN: {
+            size_t length = 0;
+            CMCall(res, PutString, col->name,
+                   CMDBM_Oracle_BinaryHex(col, csr->row, &length));
+            break;
+        }
+        case SQLT_CLOB:
+        case SQLT_BLOB: {
+            size_t length = 0;
+            const char *lob = CMDBM_Oracle_LobValue(
+                        csr->conn, col, csr->row, &length);
+            if (lob == NULL) {
+                CMCall(res, PutNull, col->name);
+            } else if (col->typecd == SQLT_BLOB) {
+                col->hexbuf = (char*)CMDBM_BufferGrow(
+                            col->hexbuf, &col->hexcap, length * 2 + 1, 0);
+                CMDBM_HexEncode(lob, length, col->hexbuf);
+                CMCall(res, PutString, col->name, col->hexbuf);
+            } else {
+                CMCall(res, PutString, col->name, lob);
+            }
+            break;
+        }
+        default:
+            // SQLT_STR values are null terminated by OCI.
+            CMCall(res, PutString, col->name, value);
         }
     }
-FAILEDPOINT:
     return res;
 }
 
+CMDBM_STATIC uint32_t CMDBM_Oracle_FetchSize(CMDBM_OracleSession *conn)
+{
+    return conn->fetchsize > 0? conn->fetchsize:CMDBM_ORACLE_FETCH_ROWS;
+}
+
 CMDBM_STATIC CMUTIL_JsonObject *CMDBM_Oracle_GetRow(
         void *initres, void *connection,
         CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
 {
     CMDBM_OracleSession *conn = (CMDBM_OracleSession*)connection;
-    CMUTIL_Array *outcols = CMUTIL_ArrayCreateEx(
-                10, NULL, CMDBM_OracleColumnDestroy);
-    OCIStmt *stmt = CMDBM_Oracle_SelectBase(conn, query, binds, outs, outcols);
-    CMUTIL_JsonObject *res = CMDBM_Oracle_FetchRow(conn, stmt, outcols);
+    CMUTIL_JsonObject *res = NULL;
+    CMDBM_Oracle_Cursor *csr =
+            CMDBM_Oracle_CursorCreate(conn, query, binds, outs, 1);
+    if (csr) {
+        res = CMDBM_Oracle_FetchRow(csr);
+        CMDBM_Oracle_CloseCursor(csr);
+    }
     if (res == NULL)
         CMLogError("cannot fetch row.\n%s", CMCall(query, GetCString));
-
-    CMCall(outcols, Destroy);
-    if (stmt) OCIHandleFree(stmt, OCI_HTYPE_STMT);
     CMUTIL_UNUSED(initres);
     return res;
 }
@@ -733,29 +1129,31 @@ CMDBM_STATIC CMUTIL_JsonArray *CMDBM_Oracle_GetList(
         CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
 {
     CMDBM_OracleSession *conn = (CMDBM_OracleSession*)connection;
-    CMUTIL_Array *outcols = CMUTIL_ArrayCreateEx(
-                10, NULL, CMDBM_OracleColumnDestroy);
-    OCIStmt *stmt = CMDBM_Oracle_SelectBase(conn, query, binds, outs, outcols);
     CMUTIL_JsonObject *row = NULL;
-    CMUTIL_JsonArray *res = CMUTIL_JsonArrayCreate();
-
-    while ((row = CMDBM_Oracle_FetchRow(conn, stmt, outcols)) != NULL)
-        CMCall(res, Add, (CMUTIL_Json*)row);
+    CMUTIL_JsonArray *res = NULL;
+    CMDBM_Oracle_Cursor *csr = CMDBM_Oracle_CursorCreate(
+                conn, query, binds, outs, CMDBM_Oracle_FetchSize(conn));
 
-    CMCall(outcols, Destroy);
-    if (stmt) OCIHandleFree(stmt, OCI_HTYPE_STMT);
+    if (csr) {
+        res = CMUTIL_JsonArrayCreate();
+        while ((row = CMDBM_Oracle_FetchRow(csr)) != NULL)
+            CMCall(res, Add, (CMUTIL_Json*)row);
+        CMDBM_Oracle_CloseCursor(csr);
+    }
     CMUTIL_UNUSED(initres);
     return res;
 }
 
-CMDBM_STATIC int CMDBM_Oracle_Execute(
+CMDBM_STATIC int CMDBM_Oracle_ExecuteLob(
         void *initres, void *connection,
-        CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
+        CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs,
+        CMDBM_LobSource **lobs)
 {
     int res = -1;
     sb4 status;
     CMDBM_OracleSession *conn = (CMDBM_OracleSession*)connection;
-    OCIStmt *stmt = CMDBM_Oracle_ExecuteBase(conn, query, binds, outs);
+    OCIStmt *stmt = CMDBM_Oracle_ExecuteBase(
+                conn, query, binds, outs, 0, lobs);
 
     if (!stmt) goto FAILEDPOINT;
     CMDBM_OracleCheck(conn, status, FAILEDPOINT, OCIAttrGet,
@@ -768,57 +1166,160 @@ FAILEDPOINT:
     return res;
 }
 
-typedef struct CMDBM_Oracle_Cursor {
-    CMDBM_OracleSession    *conn;
-    OCIStmt                *stmt;
-    CMUTIL_Array        *outcols;
-    CMBool            isend;
-    int                 dummy_padder;
-} CMDBM_Oracle_Cursor;
+CMDBM_STATIC int CMDBM_Oracle_Execute(
+        void *initres, void *connection,
+        CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
+{
+    return CMDBM_Oracle_ExecuteLob(
+                initres, connection, query, binds, outs, NULL);
+}
 
 CMDBM_STATIC void *CMDBM_Oracle_OpenCursor(
         void *initres, void *connection,
         CMUTIL_String *query, CMUTIL_JsonArray *binds, CMUTIL_JsonObject *outs)
 {
-    CMDBM_Oracle_Cursor *res = NULL;
     CMDBM_OracleSession *conn = (CMDBM_OracleSession*)connection;
-    CMUTIL_Array *outcols = CMUTIL_ArrayCreateEx(
-                10, NULL, CMDBM_OracleColumnDestroy);
-    OCIStmt *stmt = CMDBM_Oracle_SelectBase(conn, query, binds, outs, outcols);
-
-    if (stmt) {
-        res = CMAlloc(sizeof(CMDBM_Oracle_Cursor));
-        memset(res, 0x0, sizeof(CMDBM_Oracle_Cursor));
-        res->conn = conn;
-        res->outcols = outcols;
-        res->stmt = stmt;
-    } else {
-        CMCall(outcols, Destroy);
-    }
     CMUTIL_UNUSED(initres);
-    return res;
+    return CMDBM_Oracle_CursorCreate(
+                conn, query, binds, outs, CMDBM_Oracle_FetchSize(conn));
 }
 
-CMDBM_STATIC void CMDBM_Oracle_CloseCursor(void *cursor)
+CMDBM_STATIC CMUTIL_JsonObject *CMDBM_Oracle_CursorNextRow(void *cursor)
 {
     CMDBM_Oracle_Cursor *csr = (CMDBM_Oracle_Cursor*)cursor;
-    if (csr) {
-        if (csr->outcols) CMCall(csr->outcols, Destroy);
-        if (csr->stmt) OCIHandleFree(csr->stmt, OCI_HTYPE_STMT);
-        CMFree(csr);
+    return CMDBM_Oracle_FetchRow(csr);
+}
+
+CMDBM_STATIC CMBool CMDBM_Oracle_CursorFetch(void *cursor)
+{
+    CMDBM_Oracle_Cursor *csr = (CMDBM_Oracle_Cursor*)cursor;
+    return csr? CMDBM_Oracle_NextRow(csr):CMFalse;
+}
+
+CMDBM_STATIC uint32_t CMDBM_Oracle_CursorColumnCount(void *cursor)
+{
+    CMDBM_Oracle_Cursor *csr = (CMDBM_Oracle_Cursor*)cursor;
+    return (uint32_t)CMCall(csr->outcols, GetSize);
+}
+
+CMDBM_STATIC const char *CMDBM_Oracle_CursorColumnName(
+        void *cursor, uint32_t index)
+{
+    CMDBM_Oracle_Cursor *csr = (CMDBM_Oracle_Cursor*)cursor;
+    CMDBM_OracleColumn *col =
+            (CMDBM_OracleColumn*)CMCall(csr->outcols, GetAt, index);
+    return col? col->name:NULL;
+}
+
+CMDBM_STATIC CMJsonValueType CMDBM_Oracle_CursorColumnType(
+        void *cursor, uint32_t index)
+{
+    CMDBM_Oracle_Cursor *csr = (CMDBM_Oracle_Cursor*)cursor;
+    CMDBM_OracleColumn *col =
+            (CMDBM_OracleColumn*)CMCall(csr->outcols, GetAt, index);
+    if (col == NULL)
+        return CMJsonValueNull;
+    switch(col->typecd) {
+    case SQLT_INT: return CMJsonValueLong;
+    case SQLT_FLT: return CMJsonValueDouble;
+    default: return CMJsonValueString;
     }
 }
 
-CMDBM_STATIC CMUTIL_JsonObject *CMDBM_Oracle_CursorNextRow(void *cursor)
+CMDBM_STATIC CMBool CMDBM_Oracle_CursorGetValue(
+        void *cursor, uint32_t index, CMDBM_ColumnValue *value)
 {
     CMDBM_Oracle_Cursor *csr = (CMDBM_Oracle_Cursor*)cursor;
-    if (!csr->isend) {
-        CMUTIL_JsonObject *res =
-                CMDBM_Oracle_FetchRow(csr->conn, csr->stmt, csr->outcols);
-        if (res == NULL)
-            csr->isend = CMTrue;
+    CMDBM_OracleColumn *col =
+            (CMDBM_OracleColumn*)CMCall(csr->outcols, GetAt, index);
+    char *data = NULL;
+    if (col == NULL)
+        return CMFalse;
+    value->length = 0;
+    if (col->indicators[csr->row] == -1) {
+        value->type = CMJsonValueNull;
+        return CMTrue;
+    }
+    data = (char*)col->buffer + (col->bufsz * csr->row);
+    switch(col->typecd) {
+    case SQLT_INT:
+        value->type = CMJsonValueLong;
+        value->u.lval = *((int64_t*)data);
+        break;
+    case SQLT_FLT:
+        value->type = CMJsonValueDouble;
+        value->u.dval = *((double*)data);
+        break;
+    case SQLT_TIMESTAMP:
+    case SQLT_TIMESTAMP_TZ: {
+        CMDBM_DateTime dt;
+        if (!CMDBM_Oracle_GetDateTime(csr->conn, col, csr->row, &dt))
+            return CMFalse;
+        CMDBM_DateTimeToValue(&dt, col->textbuf, value);
+        break;
+    }
+    case SQLT_BIN:
+        value->type = CMJsonValueString;
+        value->u.sval = CMDBM_Oracle_BinaryHex(
+                    col, csr->row, &(value->length));
+        value->kind = CMDBM_ValueBinary;
+        value->native.bin.data = data;
+        value->native.bin.length = (size_t)col->lengths[csr->row];
+        break;
+    case SQLT_CLOB:
+        value->type = CMJsonValueString;
+        value->u.sval = CMDBM_Oracle_LobValue(
+                    csr->conn, col, csr->row, &(value->length));
+        if (value->u.sval == NULL)
+            return CMFalse;
+        break;
+    case SQLT_BLOB:
+        data = (char*)CMDBM_Oracle_LobValue(
+                    csr->conn, col, csr->row, &(value->length));
+        if (data == NULL)
+            return CMFalse;
+        col->hexbuf = (char*)CMDBM_BufferGrow(
+                    col->hexbuf, &col->hexcap, value->length * 2 + 1, 0);
+        value->type = CMJsonValueString;
+        value->native.bin.data = data;
+        value->native.bin.length = value->length;
+        value->length = CMDBM_HexEncode(data, value->length, col->hexbuf);
+        value->u.sval = col->hexbuf;
+        value->kind = CMDBM_ValueBinary;
+        break;
+    default:
+        value->type = CMJsonValueString;
+        value->u.sval = data;
+        value->length = strlen(data);
+        if (col->kind == CMDBM_ValueDecimal)
+            CMDBM_DecimalToValue(data, value->length, col->scale, value);
     }
-    return NULL;
+    return CMTrue;
+}
+
+CMDBM_STATIC int64_t CMDBM_Oracle_CursorReadLob(
+        void *cursor, uint32_t index, CMBool restart, void *buf, size_t size)
+{
+    CMDBM_Oracle_Cursor *csr = (CMDBM_Oracle_Cursor*)cursor;
+    CMDBM_OracleColumn *col =
+            (CMDBM_OracleColumn*)CMCall(csr->outcols, GetAt, index);
+    if (col == NULL || col->dtype != OCI_DTYPE_LOB) {
+        CMLogError("column %u is not lob column.", index);
+        return -1;
+    }
+    if (col->indicators[csr->row] == -1)
+        return 0;
+    if (restart)
+        col->lobpos = 1;
+    return CMDBM_Oracle_LobRead(csr->conn, col, csr->row, buf, size);
+}
+
+CMDBM_STATIC void CMDBM_Oracle_SetFetchSize(
+        void *initres, void *connection, uint32_t rows)
+{
+    CMDBM_OracleSession *conn = (CMDBM_OracleSession*)connection;
+    conn->fetchsize = rows;
+    CMUTIL_UNUSED(initres);
 }
 
 CMDBM_ModuleInterface g_cmdbm_oracle_interface = {
@@ -841,7 +1342,19 @@ CMDBM_ModuleInterface g_cmdbm_oracle_interface = {
     CMDBM_Oracle_Execute,
     CMDBM_Oracle_OpenCursor,
     CMDBM_Oracle_CloseCursor,
-    CMDBM_Oracle_CursorNextRow
+    CMDBM_Oracle_CursorNextRow,
+    NULL, NULL,
+    CMDBM_Oracle_SetFetchSize,
+    CMDBM_Oracle_CursorColumnCount,
+    CMDBM_Oracle_CursorColumnName,
+    CMDBM_Oracle_CursorFetch,
+    CMDBM_Oracle_CursorGetValue,
+    CMDBM_Oracle_CursorColumnType,
+    CMDBM_Oracle_CursorReadLob,
+    CMDBM_Oracle_ExecuteLob,
+    CMDBM_Oracle_PingConnection,
+    NULL, NULL,
+    NULL
 };
 
 #endif
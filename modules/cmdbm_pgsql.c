@@ -29,6 +29,8 @@ typedef struct CMDBM_PgSQLCtx {
 typedef struct CMDBM_PgSQLConn {
     PGconn *conn;
     CMBool autocommit;
+    CMBool pendingbegin;    // BEGIN not yet sent for this transaction
+    CMBool inbegin;         // BEGIN sent, not committed nor rolled back
     int dummy_padder;
 } CMDBM_PgSQLConn;
 
@@ -67,7 +69,7 @@ CMDBM_STATIC char *CMDBM_PgSQL_GetBindString(
         typestr = "bool";
         break;
     default:
-        typestr = "varchar[]";
+        typestr = "varchar";
         break;
     }
     sprintf(buffer, "$%d::%s", (index+1), typestr);
@@ -90,6 +92,23 @@ CMDBM_STATIC void CMDBM_PgSQL_CloseConnection(
     CMUTIL_UNUSED(initres);
 }
 
+CMDBM_STATIC CMBool CMDBM_PgSQL_PingConnection(
+        void *initres, void *connection)
+{
+    CMBool res = CMFalse;
+    PGresult *rs = NULL;
+    CMDBM_PgSQLConn *sess = (CMDBM_PgSQLConn*)connection;
+    CMUTIL_UNUSED(initres);
+    if (PQstatus(sess->conn) != CONNECTION_OK)
+        return CMFalse;
+    // empty query is a round trip without parsing or planning.
+    rs = PQexec(sess->conn, "");
+    if (rs && PQresultStatus(rs) == PGRES_EMPTY_QUERY)
+        res = CMTrue;
+    PQclear(rs);
+    return res;
+}
+
 #define CMDBM_PGSQL_MAX_PAIRS   128
 
 CMDBM_STATIC void *CMDBM_PgSQL_OpenConnection(
@@ -173,27 +192,50 @@ CMDBM_STATIC CMBool CMDBM_PgSQL_StartTransaction(
 {
     CMDBM_PgSQLConn *sess = (CMDBM_PgSQLConn*)connection;
     CMUTIL_UNUSED(initres);
+    // BEGIN is sent with the first statement of transaction.
     sess->autocommit = CMFalse;
-    CMDBM_PgSQLCheck(sess->conn, FAILED, PQexec, sess->conn, "BEGIN");
+    sess->pendingbegin = CMTrue;
     return CMTrue;
-FAILED:
-    return CMFalse;
+}
+
+// prefixes pending BEGIN, both are sent in one round trip.
+CMDBM_STATIC void CMDBM_PgSQL_PrefixBegin(
+        CMDBM_PgSQLConn *sess, CMUTIL_String *sql)
+{
+    if (sess->pendingbegin) {
+        CMCall(sql, AddString, "BEGIN; ");
+        sess->pendingbegin = CMFalse;
+        sess->inbegin = CMTrue;
+    }
 }
 
 CMDBM_STATIC void CMDBM_PgSQL_EndTransaction(
         void *initres, void *connection)
 {
     CMDBM_PgSQLConn *sess = (CMDBM_PgSQLConn*)connection;
-    sess->autocommit = CMTrue;
     CMUTIL_UNUSED(initres);
+    sess->autocommit = CMTrue;
+    sess->pendingbegin = CMFalse;
+    // open server transaction must not reach next user of connection.
+    if (sess->inbegin) {
+        CMLogWarn("transaction ended without commit, rolling back.");
+        CMDBM_PgSQLCheck(sess->conn, FAILED, PQexec, sess->conn, "ROLLBACK");
+    }
+FAILED:
+    sess->inbegin = CMFalse;
 }
 
 CMDBM_STATIC CMBool CMDBM_PgSQL_CommitTransaction(
         void *initres, void *connection)
 {
     CMDBM_PgSQLConn *conn = (CMDBM_PgSQLConn*)connection;
-    CMDBM_PgSQLCheck(conn->conn, FAILED, PQexec, conn->conn, "COMMIT");
     CMUTIL_UNUSED(initres);
+    // nothing was sent since last transaction ended.
+    if (conn->pendingbegin)
+        return CMTrue;
+    CMDBM_PgSQLCheck(conn->conn, FAILED, PQexec, conn->conn, "COMMIT");
+    conn->pendingbegin = !conn->autocommit;
+    conn->inbegin = CMFalse;
     return CMTrue;
 FAILED:
     return CMFalse;
@@ -203,11 +245,522 @@ CMDBM_STATIC void CMDBM_PgSQL_RollbackTransaction(
         void *initres, void *connection)
 {
     CMDBM_PgSQLConn *sess = (CMDBM_PgSQLConn*)connection;
-    CMDBM_PgSQLCheck(sess->conn, FAILED, PQexec, sess->conn, "ROLLBACK");
     CMUTIL_UNUSED(initres);
+    if (sess->pendingbegin)
+        return;
+    CMDBM_PgSQLCheck(sess->conn, FAILED, PQexec, sess->conn, "ROLLBACK");
+    sess->pendingbegin = !sess->autocommit;
+    sess->inbegin = CMFalse;
 FAILED:;
 }
 
+#define CMDBM_PGSQL_COPY_BUFSZ  65536
+
+typedef struct CMDBM_PgSQLCopyRow {
+    CMDBM_CopyRow   base;
+    CMUTIL_String   *buf;
+    uint32_t        fcnt;
+    int             dummy_padder;
+} CMDBM_PgSQLCopyRow;
+
+CMDBM_STATIC void CMDBM_PgSQL_CopyNextField(CMDBM_PgSQLCopyRow *irow)
+{
+    if (irow->fcnt++ > 0)
+        CMCall(irow->buf, AddChar, '\t');
+}
+
+CMDBM_STATIC void CMDBM_PgSQL_CopyAddLong(CMDBM_CopyRow *row, int64_t value)
+{
+    CMDBM_PgSQLCopyRow *irow = (CMDBM_PgSQLCopyRow*)row;
+    CMDBM_PgSQL_CopyNextField(irow);
+    CMCall(irow->buf, AddPrint, "%lld", (long long)value);
+}
+
+CMDBM_STATIC void CMDBM_PgSQL_CopyAddDouble(CMDBM_CopyRow *row, double value)
+{
+    CMDBM_PgSQLCopyRow *irow = (CMDBM_PgSQLCopyRow*)row;
+    CMDBM_PgSQL_CopyNextField(irow);
+    CMCall(irow->buf, AddPrint, "%.17g", value);
+}
+
+CMDBM_STATIC void CMDBM_PgSQL_CopyAddNull(CMDBM_CopyRow *row)
+{
+    CMDBM_PgSQLCopyRow *irow = (CMDBM_PgSQLCopyRow*)row;
+    CMDBM_PgSQL_CopyNextField(irow);
+    CMCall(irow->buf, AddNString, "\\N", 2);
+}
+
+CMDBM_STATIC void CMDBM_PgSQL_CopyAddString(
+        CMDBM_CopyRow *row, const char *value)
+{
+    CMDBM_PgSQLCopyRow *irow = (CMDBM_PgSQLCopyRow*)row;
+    const char *p = value;
+    if (value == NULL) {
+        CMDBM_PgSQL_CopyAddNull(row);
+        return;
+    }
+    CMDBM_PgSQL_CopyNextField(irow);
+    // copy plain runs at once, escape only text format specials
+    while (*p) {
+        size_t n = strcspn(p, "\\\t\n\r");
+        if (n > 0)
+            CMCall(irow->buf, AddNString, p, n);
+        p += n;
+        switch (*p) {
+        case '\\': CMCall(irow->buf, AddNString, "\\\\", 2); break;
+        case '\t': CMCall(irow->buf, AddNString, "\\t", 2); break;
+        case '\n': CMCall(irow->buf, AddNString, "\\n", 2); break;
+        case '\r': CMCall(irow->buf, AddNString, "\\r", 2); break;
+        default: continue;
+        }
+        p++;
+    }
+}
+
+CMDBM_STATIC void CMDBM_PgSQL_CopyAddBoolean(CMDBM_CopyRow *row, CMBool value)
+{
+    CMDBM_PgSQLCopyRow *irow = (CMDBM_PgSQLCopyRow*)row;
+    CMDBM_PgSQL_CopyNextField(irow);
+    CMCall(irow->buf, AddChar, value? 't':'f');
+}
+
+static CMDBM_CopyRow g_cmdbm_pgsql_copyrow = {
+    CMDBM_PgSQL_CopyAddLong,
+    CMDBM_PgSQL_CopyAddDouble,
+    CMDBM_PgSQL_CopyAddString,
+    CMDBM_PgSQL_CopyAddBoolean,
+    CMDBM_PgSQL_CopyAddNull
+};
+
+CMDBM_STATIC CMBool CMDBM_PgSQL_CopyAddJson(
+        CMDBM_CopyRow *row, CMUTIL_Json *json)
+{
+    CMUTIL_JsonValue *jval = (CMUTIL_JsonValue*)json;
+    if (json == NULL) {
+        CMCall(row, AddNull);
+        return CMTrue;
+    }
+    if (CMCall(json, GetType) != CMJsonTypeValue) {
+        CMLogError("bulk load field is not value type.");
+        return CMFalse;
+    }
+    switch (CMCall(jval, GetValueType)) {
+    case CMJsonValueLong: {
+        int64_t lval = CMCall(jval, GetLong);
+        CMCall(row, AddLong, lval);
+        break;
+    }
+    case CMJsonValueDouble: {
+        double dval = CMCall(jval, GetDouble);
+        CMCall(row, AddDouble, dval);
+        break;
+    }
+    case CMJsonValueString: {
+        const char *sval = CMCall(jval, GetCString);
+        CMCall(row, AddString, sval);
+        break;
+    }
+    case CMJsonValueBoolean: {
+        CMBool bval = CMCall(jval, GetBoolean);
+        CMCall(row, AddBoolean, bval);
+        break;
+    }
+    default:
+        CMCall(row, AddNull);
+        break;
+    }
+    return CMTrue;
+}
+
+CMDBM_STATIC CMBool CMDBM_PgSQL_CopyAddJsonRow(
+        CMDBM_CopyRow *row, CMUTIL_Json *json, CMUTIL_StringArray *columns)
+{
+    uint32_t i;
+    if (json && CMCall(json, GetType) == CMJsonTypeArray) {
+        CMUTIL_JsonArray *arr = (CMUTIL_JsonArray*)json;
+        for (i=0; i<CMCall(arr, GetSize); i++) {
+            CMUTIL_Json *item = CMCall(arr, Get, i);
+            if (!CMDBM_PgSQL_CopyAddJson(row, item))
+                return CMFalse;
+        }
+    } else if (json && CMCall(json, GetType) == CMJsonTypeObject) {
+        CMUTIL_JsonObject *obj = (CMUTIL_JsonObject*)json;
+        if (columns == NULL || CMCall(columns, GetSize) == 0) {
+            CMLogError("column list is required for object type rows.");
+            return CMFalse;
+        }
+        for (i=0; i<CMCall(columns, GetSize); i++) {
+            const char *col = CMCall(columns, GetCString, i);
+            CMUTIL_Json *item = CMCall(obj, Get, col);
+            if (!CMDBM_PgSQL_CopyAddJson(row, item))
+                return CMFalse;
+        }
+    } else {
+        CMLogError("bulk load row is not array or object type.");
+        return CMFalse;
+    }
+    return CMTrue;
+}
+
+CMDBM_STATIC CMBool CMDBM_PgSQL_CopyFlush(PGconn *conn, CMUTIL_String *buf)
+{
+    size_t size = CMCall(buf, GetSize);
+    if (size > 0) {
+        if (PQputCopyData(conn, CMCall(buf, GetCString), (int)size) != 1) {
+            CMLogError("PQputCopyData failed: %s", PQerrorMessage(conn));
+            return CMFalse;
+        }
+        CMCall(buf, CutTailOff, size);
+    }
+    return CMTrue;
+}
+
+CMDBM_STATIC int CMDBM_PgSQL_CopyResult(PGconn *conn)
+{
+    int res = -1;
+    CMBool failed = CMFalse;
+    PGresult *pr = NULL;
+    while ((pr = PQgetResult(conn)) != NULL) {
+        if (PQresultStatus(pr) == PGRES_COMMAND_OK) {
+            res = atoi(PQcmdTuples(pr));
+        } else {
+            CMLogError("COPY failed: %s", PQresultErrorMessage(pr));
+            failed = CMTrue;
+        }
+        PQclear(pr);
+    }
+    return failed? -1:res;
+}
+
+// appends quoted identifier, 'len' bytes of 'name'.
+CMDBM_STATIC CMBool CMDBM_PgSQL_AddIdent(
+        PGconn *conn, CMUTIL_String *sql, const char *name, size_t len)
+{
+    char *quoted = PQescapeIdentifier(conn, name, len);
+    if (quoted == NULL) {
+        CMLogError("cannot quote identifier: %s", PQerrorMessage(conn));
+        return CMFalse;
+    }
+    CMCall(sql, AddString, quoted);
+    PQfreemem(quoted);
+    return CMTrue;
+}
+
+CMDBM_STATIC int CMDBM_PgSQL_CopyIn(
+        void *initres, void *connection, const char *table,
+        CMUTIL_StringArray *columns, CMUTIL_JsonArray *rows, void *udata,
+        CMBool (*rowcb)(CMDBM_CopyRow*, uint32_t, void*))
+{
+    CMDBM_PgSQLConn *sess = (CMDBM_PgSQLConn*)connection;
+    CMUTIL_String *sql = CMUTIL_StringCreate();
+    CMUTIL_String *stmt = CMUTIL_StringCreate();
+    const char *part = table;
+    CMDBM_PgSQLCopyRow irow;
+    PGresult *pr = NULL;
+    const char *errmsg = NULL;
+    uint32_t i, rownum = 0;
+    int res = -1;
+    CMUTIL_UNUSED(initres);
+
+    // text format is used: binary format needs exact column types
+    // and bypasses client encoding conversion.
+    // names are quoted as given, schema qualified table part by part.
+    CMCall(stmt, AddString, "COPY ");
+    for (;;) {
+        const char *dot = strchr(part, '.');
+        size_t len = dot? (size_t)(dot - part):strlen(part);
+        if (!CMDBM_PgSQL_AddIdent(sess->conn, stmt, part, len))
+            goto ENDPOINT;
+        if (dot == NULL)
+            break;
+        CMCall(stmt, AddChar, '.');
+        part = dot + 1;
+    }
+    if (columns && CMCall(columns, GetSize) > 0) {
+        CMCall(stmt, AddString, " (");
+        for (i=0; i<CMCall(columns, GetSize); i++) {
+            const char *col = CMCall(columns, GetCString, i);
+            if (i > 0)
+                CMCall(stmt, AddString, ", ");
+            if (!CMDBM_PgSQL_AddIdent(sess->conn, stmt, col, strlen(col)))
+                goto ENDPOINT;
+        }
+        CMCall(stmt, AddChar, ')');
+    }
+    CMCall(stmt, AddString, " FROM STDIN");
+    CMDBM_PgSQL_PrefixBegin(sess, sql);
+    CMCall(sql, AddAnother, stmt);
+
+    pr = PQexec(sess->conn, CMCall(sql, GetCString));
+    if (PQresultStatus(pr) != PGRES_COPY_IN) {
+        CMLogError("%s failed: %s", CMCall(sql, GetCString),
+                   PQerrorMessage(sess->conn));
+        PQclear(pr);
+        goto ENDPOINT;
+    }
+    PQclear(pr);
+
+    memset(&irow, 0x0, sizeof(CMDBM_PgSQLCopyRow));
+    memcpy(&irow, &g_cmdbm_pgsql_copyrow, sizeof(CMDBM_CopyRow));
+    irow.buf = CMUTIL_StringCreate();
+    while (errmsg == NULL) {
+        size_t mark = CMCall(irow.buf, GetSize), size = 0;
+        CMBool more = CMTrue;
+        irow.fcnt = 0;
+        if (rows) {
+            CMUTIL_Json *item = NULL;
+            if (rownum >= CMCall(rows, GetSize))
+                break;
+            item = CMCall(rows, Get, rownum);
+            if (!CMDBM_PgSQL_CopyAddJsonRow(
+                        (CMDBM_CopyRow*)&irow, item, columns))
+                errmsg = "invalid row data";
+        } else {
+            more = rowcb((CMDBM_CopyRow*)&irow, rownum, udata);
+        }
+        if (!more || errmsg) {
+            // discard partially written row
+            size = CMCall(irow.buf, GetSize);
+            CMCall(irow.buf, CutTailOff, size - mark);
+            break;
+        }
+        CMCall(irow.buf, AddChar, '\n');
+        rownum++;
+        if (CMCall(irow.buf, GetSize) >= CMDBM_PGSQL_COPY_BUFSZ &&
+                !CMDBM_PgSQL_CopyFlush(sess->conn, irow.buf))
+            errmsg = "sending data failed";
+    }
+    if (errmsg == NULL && !CMDBM_PgSQL_CopyFlush(sess->conn, irow.buf))
+        errmsg = "sending data failed";
+    if (PQputCopyEnd(sess->conn, errmsg) != 1)
+        CMLogError("PQputCopyEnd failed: %s", PQerrorMessage(sess->conn));
+    res = CMDBM_PgSQL_CopyResult(sess->conn);
+    if (errmsg) {
+        CMLogError("bulk load into %s aborted: %s", table, errmsg);
+        res = -1;
+    }
+    CMCall(irow.buf, Destroy);
+ENDPOINT:
+    CMCall(stmt, Destroy);
+    CMCall(sql, Destroy);
+    return res;
+}
+
+CMDBM_STATIC CMBool CMDBM_PgSQL_AddLiteral(
+        PGconn *conn, CMUTIL_String *buf, CMUTIL_Json *json)
+{
+    CMUTIL_JsonValue *jval = (CMUTIL_JsonValue*)json;
+    const char *str = NULL;
+    char *lit = NULL;
+    int64_t lval = 0;
+    double dval = 0.0;
+    CMBool bval = CMFalse;
+    if (CMCall(json, GetType) != CMJsonTypeValue) {
+        CMLogError("binding variable is not value type.");
+        return CMFalse;
+    }
+    switch (CMCall(jval, GetValueType)) {
+    case CMJsonValueLong:
+        lval = CMCall(jval, GetLong);
+        CMCall(buf, AddPrint, "%lld", (long long)lval);
+        break;
+    case CMJsonValueDouble:
+        dval = CMCall(jval, GetDouble);
+        CMCall(buf, AddPrint, "'%.17g'", dval);
+        break;
+    case CMJsonValueBoolean:
+        bval = CMCall(jval, GetBoolean);
+        CMCall(buf, AddString, bval? "true":"false");
+        break;
+    case CMJsonValueString:
+        str = CMCall(jval, GetCString);
+        lit = PQescapeLiteral(conn, str, strlen(str));
+        if (lit == NULL) {
+            CMLogError("PQescapeLiteral failed: %s", PQerrorMessage(conn));
+            return CMFalse;
+        }
+        CMCall(buf, AddString, lit);
+        PQfreemem(lit);
+        break;
+    default:
+        CMCall(buf, AddString, "NULL");
+        break;
+    }
+    return CMTrue;
+}
+
+/*
+ * Returns end of string literal, quoted identifier, comment or dollar
+ * quoted string starting at 'p', or 'p' if none starts there. Unclosed
+ * ones run to the end of query.
+ */
+CMDBM_STATIC const char *CMDBM_PgSQL_SkipLexeme(const char *q, const char *p)
+{
+    CMBool inword = p > q && (isalnum((unsigned char)p[-1]) ||
+                              p[-1] == '_' || p[-1] == '$')? CMTrue:CMFalse;
+    if (p[0] == '-' && p[1] == '-') {
+        while (*p && *p != '\n')
+            p++;
+    } else if (p[0] == '/' && p[1] == '*') {
+        // block comments nest.
+        int depth = 0;
+        while (*p) {
+            if (p[0] == '/' && p[1] == '*') {
+                depth++;
+                p += 2;
+            } else if (p[0] == '*' && p[1] == '/') {
+                p += 2;
+                if (--depth == 0)
+                    break;
+            } else {
+                p++;
+            }
+        }
+    } else if ((*p == 'E' || *p == 'e') && p[1] == '\'' && !inword) {
+        // escape string, backslash escapes next character.
+        p += 2;
+        while (*p) {
+            if (p[0] == '\\' && p[1])
+                p += 2;
+            else if (p[0] == '\'' && p[1] == '\'')
+                p += 2;
+            else if (*p++ == '\'')
+                break;
+        }
+    } else if (*p == '\'' || *p == '"') {
+        char quote = *p++;
+        while (*p) {
+            if (p[0] == quote && p[1] == quote)
+                p += 2;
+            else if (*p++ == quote)
+                break;
+        }
+    } else if (*p == '$' && !inword) {
+        // $tag$ ... $tag$, tag is empty or an identifier.
+        const char *t = p + 1, *e = NULL;
+        size_t len = 0;
+        if (isalpha((unsigned char)*t) || *t == '_')
+            while (isalnum((unsigned char)*t) || *t == '_')
+                t++;
+        if (*t != '$')
+            return p;
+        len = (size_t)(t - p) + 1;
+        e = p + len;
+        while ((e = strchr(e, '$')) != NULL && strncmp(e, p, len) != 0)
+            e++;
+        p = e? e + len:p + strlen(p);
+    }
+    return p;
+}
+
+/*
+ * COPY does not accept bind parameters,
+ * so $n placeholders are replaced with escaped literals. Placeholders
+ * inside literals, quoted identifiers and comments are left alone.
+ */
+CMDBM_STATIC CMUTIL_String *CMDBM_PgSQL_InlineBinds(
+        PGconn *conn, CMUTIL_String *query, CMUTIL_JsonArray *binds)
+{
+    const char *q = CMCall(query, GetCString), *p = q;
+    size_t bcnt = binds? CMCall(binds, GetSize):0;
+    CMUTIL_String *res = CMUTIL_StringCreate();
+    while (*p) {
+        const char *e = CMDBM_PgSQL_SkipLexeme(q, p);
+        if (e != p) {
+            CMCall(res, AddNString, p, (size_t)(e - p));
+            p = e;
+            continue;
+        } else if (*p == '$' && isdigit((unsigned char)p[1]) &&
+                   (p == q || !(isalnum((unsigned char)p[-1]) ||
+                                p[-1] == '_'))) {
+            char *end = NULL;
+            long idx = strtol(p+1, &end, 10);
+            if (idx < 1 || (size_t)idx > bcnt) {
+                CMLogError("invalid bind index $%ld in query.", idx);
+                goto FAILED;
+            }
+            CMUTIL_Json *item = CMCall(binds, Get, (uint32_t)(idx-1));
+            if (!CMDBM_PgSQL_AddLiteral(conn, res, item))
+                goto FAILED;
+            p = end;
+            continue;
+        }
+        CMCall(res, AddChar, *p);
+        p++;
+    }
+    return res;
+FAILED:
+    CMCall(res, Destroy);
+    return NULL;
+}
+
+CMDBM_STATIC void CMDBM_PgSQL_Cancel(PGconn *conn)
+{
+    char errbuf[256];
+    PGcancel *cancel = PQgetCancel(conn);
+    if (cancel) {
+        if (!PQcancel(cancel, errbuf, sizeof(errbuf)))
+            CMLogWarn("PQcancel failed: %s", errbuf);
+        PQfreeCancel(cancel);
+    }
+}
+
+CMDBM_STATIC int CMDBM_PgSQL_CopyOut(
+        void *initres, void *connection, CMUTIL_String *query,
+        CMUTIL_JsonArray *binds, CMDBM_CopyFormat format, void *udata,
+        CMBool (*sink)(const char*, size_t, void*))
+{
+    CMDBM_PgSQLConn *sess = (CMDBM_PgSQLConn*)connection;
+    CMUTIL_String *sql = NULL, *inlined = NULL;
+    PGresult *pr = NULL;
+    CMBool cancelled = CMFalse;
+    char *data = NULL;
+    int res = -1, len = 0;
+    CMUTIL_UNUSED(initres);
+
+    inlined = CMDBM_PgSQL_InlineBinds(sess->conn, query, binds);
+    if (inlined == NULL)
+        goto ENDPOINT;
+    sql = CMUTIL_StringCreate();
+    CMDBM_PgSQL_PrefixBegin(sess, sql);
+    CMCall(sql, AddString, "COPY (");
+    CMCall(sql, AddAnother, inlined);
+    CMCall(sql, AddString, ") TO STDOUT");
+    if (format == CMDBM_CopyCSV)
+        CMCall(sql, AddString, " WITH (FORMAT csv)");
+    else if (format == CMDBM_CopyBinary)
+        CMCall(sql, AddString, " WITH (FORMAT binary)");
+
+    pr = PQexec(sess->conn, CMCall(sql, GetCString));
+    if (PQresultStatus(pr) != PGRES_COPY_OUT) {
+        CMLogError("%s failed: %s", CMCall(sql, GetCString),
+                   PQerrorMessage(sess->conn));
+        PQclear(pr);
+        goto ENDPOINT;
+    }
+    PQclear(pr);
+
+    while ((len = PQgetCopyData(sess->conn, &data, 0)) > 0) {
+        if (!cancelled && !sink(data, (size_t)len, udata)) {
+            // keep draining until server acknowledges the cancel
+            cancelled = CMTrue;
+            CMDBM_PgSQL_Cancel(sess->conn);
+        }
+        PQfreemem(data);
+    }
+    if (len == -2)
+        CMLogError("PQgetCopyData failed: %s", PQerrorMessage(sess->conn));
+    res = CMDBM_PgSQL_CopyResult(sess->conn);
+    if (cancelled) {
+        CMLogInfo("bulk export cancelled by sink.");
+        res = -1;
+    }
+ENDPOINT:
+    if (sql) CMCall(sql, Destroy);
+    if (inlined) CMCall(inlined, Destroy);
+    return res;
+}
+
 /*
  * TODO: build code
  *
@@ -254,7 +807,7 @@ CMDBM_ModuleInterface g_cmdbm_pgsql_interface = {
     CMDBM_PgSQL_EndTransaction,
     CMDBM_PgSQL_CommitTransaction,
     CMDBM_PgSQL_RollbackTransaction,
-    NULL, NULL, NULL, NULL, NULL, NULL, NULL
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL,
 //    CMDBM_Oracle_GetOneValue,
 //    CMDBM_Oracle_GetRow,
 //    CMDBM_Oracle_GetList,
@@ -262,6 +815,15 @@ CMDBM_ModuleInterface g_cmdbm_pgsql_interface = {
 //    CMDBM_Oracle_OpenCursor,
 //    CMDBM_Oracle_CloseCursor,
 //    CMDBM_Oracle_CursorNextRow
+    CMDBM_PgSQL_CopyIn,
+    CMDBM_PgSQL_CopyOut,
+    NULL,
+    NULL, NULL, NULL, NULL,
+    NULL,
+    NULL, NULL,
+    CMDBM_PgSQL_PingConnection,
+    NULL, NULL,
+    NULL
 };
 
 #endif
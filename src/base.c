@@ -1,18 +1,24 @@
 
 #include "functions.h"
 
+#if !defined(MSWIN)
+# include <time.h>
+#endif
+
 #define LIBCMDBM_VER LIBCMDBM_VERSION_STRING
 
 void CMDBM_Init()
 {
     CMUTIL_Init(CMMemSystem);
     CMDBM_MapperInit();
+    CMDBM_PoolInit();
     CMDBM_DatabaseInit();
 }
 
 void CMDBM_Clear()
 {
     CMDBM_DatabaseClear();
+    CMDBM_PoolClear();
     CMDBM_MapperClear();
     CMUTIL_Clear();
 }
@@ -22,3 +28,99 @@ const char *CMDBM_GetLibVersion()
     static char *verstr = LIBCMDBM_VER;
     return verstr;
 }
+
+void *CMDBM_BufferGrow(void *buf, size_t *cap, size_t need, size_t keep)
+{
+    if (need > *cap) {
+        size_t ncap = *cap > 0? *cap:256;
+        void *nbuf = NULL;
+        while (ncap < need)
+            ncap <<= 1;
+        nbuf = CMAlloc(ncap);
+        if (buf) {
+            if (keep > 0)
+                memcpy(nbuf, buf, keep);
+            CMFree(buf);
+        }
+        buf = nbuf;
+        *cap = ncap;
+    }
+    return buf;
+}
+
+// days since 1970-01-01 of proleptic gregorian date.
+CMDBM_STATIC int64_t CMDBM_DaysFromCivil(int year, int month, int day)
+{
+    int64_t y = (int64_t)year - (month <= 2? 1:0);
+    int64_t era = (y >= 0? y:y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (month + (month > 2? -3:9)) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+size_t CMDBM_DateTimeFormat(const CMDBM_DateTime *dt, char *buf)
+{
+    int len = sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d",
+                      dt->year, dt->month, dt->day,
+                      dt->hour, dt->minute, dt->second);
+    if (dt->usec > 0)
+        len += sprintf(buf + len, ".%06u", (unsigned)dt->usec);
+    if (dt->hastz) {
+        int tz = dt->tzoffset < 0? -dt->tzoffset:dt->tzoffset;
+        len += sprintf(buf + len, "%c%02d:%02d",
+                       dt->tzoffset < 0? '-':'+', tz / 60, tz % 60);
+    }
+    return (size_t)len;
+}
+
+void CMDBM_DateTimeToValue(
+        const CMDBM_DateTime *dt, char *buf, CMDBM_ColumnValue *value)
+{
+    int64_t secs = CMDBM_DaysFromCivil(dt->year, dt->month, dt->day) * 86400
+            + dt->hour * 3600 + dt->minute * 60 + dt->second;
+    // wall clock time of the zone, epoch is in UTC.
+    if (dt->hastz)
+        secs -= (int64_t)dt->tzoffset * 60;
+    value->type = CMJsonValueString;
+    value->kind = CMDBM_ValueTimestamp;
+    value->length = CMDBM_DateTimeFormat(dt, buf);
+    value->u.sval = buf;
+    value->native.ts.micros = secs * 1000000 + dt->usec;
+    value->native.ts.tzoffset = dt->tzoffset;
+    value->native.ts.hastz = dt->hastz;
+}
+
+void CMDBM_DecimalToValue(
+        const char *digits, size_t length, int32_t scale,
+        CMDBM_ColumnValue *value)
+{
+    value->kind = CMDBM_ValueDecimal;
+    value->native.dec.digits = digits;
+    value->native.dec.length = length;
+    value->native.dec.scale = scale;
+}
+
+size_t CMDBM_HexEncode(const void *data, size_t length, char *out)
+{
+    static const char *hexchars = "0123456789ABCDEF";
+    const unsigned char *p = (const unsigned char*)data;
+    size_t i;
+    for (i=0; i<length; i++) {
+        out[i*2] = hexchars[p[i] >> 4];
+        out[i*2+1] = hexchars[p[i] & 0xF];
+    }
+    out[length*2] = 0x0;
+    return length*2;
+}
+
+int64_t CMDBM_TimeMillis(void)
+{
+#if defined(MSWIN)
+    return (int64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
@@ -0,0 +1,288 @@
+
+#include "functions.h"
+
+CMUTIL_LogDefine("cmdbm.columnar")
+
+typedef struct CMDBM_ArrowColumn {
+    const char          *name;
+    CMJsonValueType     type;
+    int                 dummy_padder;
+    uint8_t             *validity;
+    uint8_t             *values;    // int64, double, bits or int32 offsets
+    char                *data;      // string bytes
+    size_t              datacap;
+    size_t              datalen;
+    int64_t             nulls;
+} CMDBM_ArrowColumn;
+
+// private data of arrays, every buffer is owned by the array.
+typedef struct CMDBM_ArrowPrivate {
+    const void          *buffers[3];
+} CMDBM_ArrowPrivate;
+
+CMDBM_STATIC const char *CMDBM_ArrowFormat(CMJsonValueType type)
+{
+    switch (type) {
+    case CMJsonValueLong:       return "l";
+    case CMJsonValueDouble:     return "g";
+    case CMJsonValueBoolean:    return "b";
+    case CMJsonValueString:     return "u";
+    default:                    return "n";
+    }
+}
+
+CMDBM_STATIC void CMDBM_ArrowSchemaRelease(struct ArrowSchema *schema)
+{
+    int64_t i;
+    for (i=0; i<schema->n_children; i++) {
+        struct ArrowSchema *child = schema->children[i];
+        if (child->release)
+            child->release(child);
+        CMFree(child);
+    }
+    if (schema->children) CMFree(schema->children);
+    if (schema->name) CMFree((char*)schema->name);
+    schema->release = NULL;
+}
+
+CMDBM_STATIC void CMDBM_ArrowArrayRelease(struct ArrowArray *array)
+{
+    int64_t i;
+    CMDBM_ArrowPrivate *priv = (CMDBM_ArrowPrivate*)array->private_data;
+    for (i=0; i<array->n_children; i++) {
+        struct ArrowArray *child = array->children[i];
+        if (child->release)
+            child->release(child);
+        CMFree(child);
+    }
+    if (array->children) CMFree(array->children);
+    if (priv) {
+        for (i=0; i<3; i++)
+            if (priv->buffers[i]) CMFree((void*)priv->buffers[i]);
+        CMFree(priv);
+    }
+    array->release = NULL;
+}
+
+CMDBM_STATIC struct ArrowSchema *CMDBM_ArrowSchemaCreate(
+        CMDBM_ArrowColumn *cols, uint32_t colcnt)
+{
+    uint32_t i;
+    struct ArrowSchema *res = CMAlloc(sizeof(struct ArrowSchema));
+    memset(res, 0x0, sizeof(struct ArrowSchema));
+    res->format = "+s";
+    res->n_children = colcnt;
+    res->children = CMAlloc(sizeof(struct ArrowSchema*) * colcnt);
+    res->release = CMDBM_ArrowSchemaRelease;
+    for (i=0; i<colcnt; i++) {
+        struct ArrowSchema *child = CMAlloc(sizeof(struct ArrowSchema));
+        memset(child, 0x0, sizeof(struct ArrowSchema));
+        child->format = CMDBM_ArrowFormat(cols[i].type);
+        child->name = CMStrdup(cols[i].name);
+        child->flags = ARROW_FLAG_NULLABLE;
+        child->release = CMDBM_ArrowSchemaRelease;
+        res->children[i] = child;
+    }
+    return res;
+}
+
+CMDBM_STATIC void CMDBM_ArrowColumnReset(
+        CMDBM_ArrowColumn *col, uint32_t batchrows)
+{
+    size_t bits = ((size_t)batchrows + 7) / 8;
+    col->validity = CMAlloc(bits);
+    memset(col->validity, 0x0, bits);
+    col->nulls = 0;
+    col->data = NULL;
+    col->datacap = col->datalen = 0;
+    switch (col->type) {
+    case CMJsonValueLong:
+    case CMJsonValueDouble:
+        col->values = CMAlloc(sizeof(int64_t) * batchrows);
+        break;
+    case CMJsonValueBoolean:
+        col->values = CMAlloc(bits);
+        memset(col->values, 0x0, bits);
+        break;
+    case CMJsonValueString:
+        col->values = CMAlloc(sizeof(int32_t) * ((size_t)batchrows + 1));
+        ((int32_t*)col->values)[0] = 0;
+        break;
+    default:
+        col->values = NULL;
+    }
+}
+
+CMDBM_STATIC CMBool CMDBM_ArrowColumnAppend(
+        CMDBM_ArrowColumn *col, uint32_t row, const CMDBM_ColumnValue *val)
+{
+    CMBool isnull = val->type == CMJsonValueNull? CMTrue:CMFalse;
+    if (isnull)
+        col->nulls++;
+    else
+        col->validity[row >> 3] |= (uint8_t)(1 << (row & 7));
+    switch (col->type) {
+    case CMJsonValueLong:
+        ((int64_t*)col->values)[row] = isnull? 0:CMDBM_ValueToLong(val);
+        break;
+    case CMJsonValueDouble:
+        ((double*)col->values)[row] = isnull? 0.0:CMDBM_ValueToDouble(val);
+        break;
+    case CMJsonValueBoolean:
+        if (!isnull && CMDBM_ValueToBoolean(val))
+            col->values[row >> 3] |= (uint8_t)(1 << (row & 7));
+        break;
+    case CMJsonValueString:
+        if (!isnull && val->type == CMJsonValueString) {
+            if (col->datalen + val->length > INT32_MAX) {
+                CMLogErrorS("string data of column %s exceeds 2GB in batch.",
+                            col->name);
+                return CMFalse;
+            }
+            col->data = (char*)CMDBM_BufferGrow(
+                        col->data, &col->datacap,
+                        col->datalen + val->length, col->datalen);
+            memcpy(col->data + col->datalen, val->u.sval, val->length);
+            col->datalen += val->length;
+        }
+        ((int32_t*)col->values)[row + 1] = (int32_t)col->datalen;
+        break;
+    default:
+        break;
+    }
+    return CMTrue;
+}
+
+CMDBM_STATIC struct ArrowArray *CMDBM_ArrowColumnFinish(
+        CMDBM_ArrowColumn *col, uint32_t rows)
+{
+    struct ArrowArray *res = CMAlloc(sizeof(struct ArrowArray));
+    CMDBM_ArrowPrivate *priv = CMAlloc(sizeof(CMDBM_ArrowPrivate));
+    memset(res, 0x0, sizeof(struct ArrowArray));
+    memset(priv, 0x0, sizeof(CMDBM_ArrowPrivate));
+    res->length = rows;
+    res->null_count = col->type == CMJsonValueNull? rows:col->nulls;
+    res->buffers = priv->buffers;
+    res->private_data = priv;
+    res->release = CMDBM_ArrowArrayRelease;
+    if (col->type == CMJsonValueNull) {
+        // null type has no buffers at all.
+        CMFree(col->validity);
+        res->n_buffers = 0;
+    } else {
+        priv->buffers[0] = col->validity;
+        priv->buffers[1] = col->values;
+        res->n_buffers = 2;
+        if (col->type == CMJsonValueString) {
+            // data buffer must not be NULL even if it is empty.
+            if (col->data == NULL)
+                col->data = CMAlloc(1);
+            priv->buffers[2] = col->data;
+            res->n_buffers = 3;
+        }
+    }
+    col->validity = col->values = NULL;
+    col->data = NULL;
+    return res;
+}
+
+CMDBM_STATIC struct ArrowArray *CMDBM_ArrowBatchFinish(
+        CMDBM_ArrowColumn *cols, uint32_t colcnt, uint32_t rows)
+{
+    uint32_t i;
+    struct ArrowArray *res = CMAlloc(sizeof(struct ArrowArray));
+    CMDBM_ArrowPrivate *priv = CMAlloc(sizeof(CMDBM_ArrowPrivate));
+    memset(res, 0x0, sizeof(struct ArrowArray));
+    memset(priv, 0x0, sizeof(CMDBM_ArrowPrivate));
+    // struct array has only validity buffer, which is omitted.
+    res->length = rows;
+    res->n_buffers = 1;
+    res->buffers = priv->buffers;
+    res->private_data = priv;
+    res->n_children = colcnt;
+    res->children = CMAlloc(sizeof(struct ArrowArray*) * colcnt);
+    res->release = CMDBM_ArrowArrayRelease;
+    for (i=0; i<colcnt; i++)
+        res->children[i] = CMDBM_ArrowColumnFinish(&cols[i], rows);
+    return res;
+}
+
+CMDBM_STATIC void CMDBM_ArrowColumnsFree(
+        CMDBM_ArrowColumn *cols, uint32_t colcnt)
+{
+    uint32_t i;
+    for (i=0; i<colcnt; i++) {
+        if (cols[i].validity) CMFree(cols[i].validity);
+        if (cols[i].values) CMFree(cols[i].values);
+        if (cols[i].data) CMFree(cols[i].data);
+    }
+    CMFree(cols);
+}
+
+int CMDBM_ColumnarCursor(
+        CMDBM_Cursor *cursor, uint32_t batchrows, void *udata,
+        CMBool (*batchcb)(const struct ArrowSchema*, struct ArrowArray*, void*))
+{
+    int res = 0;
+    uint32_t i, rows = 0, colcnt = CMCall(cursor, GetColumnCount);
+    CMDBM_ArrowColumn *cols = NULL;
+    struct ArrowSchema *schema = NULL;
+    CMBool cont = CMTrue;
+
+    if (colcnt == 0)
+        return -1;
+    if (batchrows == 0)
+        batchrows = 1024;
+    cols = CMAlloc(sizeof(CMDBM_ArrowColumn) * colcnt);
+    memset(cols, 0x0, sizeof(CMDBM_ArrowColumn) * colcnt);
+    for (i=0; i<colcnt; i++) {
+        cols[i].name = CMCall(cursor, GetColumnName, i);
+        if (cols[i].name == NULL) cols[i].name = "";
+        cols[i].type = CMCall(cursor, GetColumnType, i);
+        CMDBM_ArrowColumnReset(&cols[i], batchrows);
+    }
+    schema = CMDBM_ArrowSchemaCreate(cols, colcnt);
+
+    while (cont) {
+        CMBool fetched = CMCall(cursor, Fetch);
+        if (!fetched && CMCall(cursor, HasFailed)) {
+            CMLogErrorS("fetching row %d failed.", res + (int)rows);
+            res = -1;
+            goto ENDPOINT;
+        }
+        if (fetched) {
+            for (i=0; i<colcnt; i++) {
+                CMDBM_ColumnValue val;
+                if (!CMCall(cursor, GetValue, i, &val) ||
+                        !CMDBM_ArrowColumnAppend(&cols[i], rows, &val)) {
+                    CMLogErrorS("cannot read column %s of row %d.",
+                                cols[i].name, res + (int)rows);
+                    res = -1;
+                    goto ENDPOINT;
+                }
+            }
+            rows++;
+        }
+        if (rows == batchrows || (!fetched && rows > 0)) {
+            struct ArrowArray *batch =
+                    CMDBM_ArrowBatchFinish(cols, colcnt, rows);
+            res += (int)rows;
+            rows = 0;
+            cont = batchcb(schema, batch, udata);
+            // callback may have moved the batch out.
+            if (batch->release)
+                batch->release(batch);
+            CMFree(batch);
+            if (cont && fetched)
+                for (i=0; i<colcnt; i++)
+                    CMDBM_ArrowColumnReset(&cols[i], batchrows);
+        }
+        if (!fetched)
+            break;
+    }
+ENDPOINT:
+    CMDBM_ArrowColumnsFree(cols, colcnt);
+    schema->release(schema);
+    CMFree(schema);
+    return res;
+}
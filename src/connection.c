@@ -84,6 +84,80 @@ CMDBM_STATIC void CMDBM_CursorClose(
     CMFree(icsr);
 }
 
+CMDBM_STATIC uint32_t CMDBM_CursorGetColumnCount(
+        CMDBM_Cursor *cursor)
+{
+    CMDBM_Cursor_Internal *icsr = (CMDBM_Cursor_Internal*)cursor;
+    if (!icsr->connref->modif->CursorColumnCount) {
+        CMLogErrorS("column access is not supported by this database module.");
+        return 0;
+    }
+    return icsr->connref->modif->CursorColumnCount(icsr->cursor);
+}
+
+CMDBM_STATIC const char *CMDBM_CursorGetColumnName(
+        CMDBM_Cursor *cursor, uint32_t index)
+{
+    CMDBM_Cursor_Internal *icsr = (CMDBM_Cursor_Internal*)cursor;
+    if (!icsr->connref->modif->CursorColumnName)
+        return NULL;
+    return icsr->connref->modif->CursorColumnName(icsr->cursor, index);
+}
+
+CMDBM_STATIC CMBool CMDBM_CursorFetch(
+        CMDBM_Cursor *cursor)
+{
+    CMDBM_Cursor_Internal *icsr = (CMDBM_Cursor_Internal*)cursor;
+    if (!icsr->connref->modif->CursorFetch) {
+        CMLogErrorS("column access is not supported by this database module.");
+        return CMFalse;
+    }
+    return icsr->connref->modif->CursorFetch(icsr->cursor);
+}
+
+CMDBM_STATIC CMBool CMDBM_CursorGetValue(
+        CMDBM_Cursor *cursor, uint32_t index, CMDBM_ColumnValue *value)
+{
+    CMDBM_Cursor_Internal *icsr = (CMDBM_Cursor_Internal*)cursor;
+    if (!icsr->connref->modif->CursorGetValue)
+        return CMFalse;
+    // modules set kind only for native values.
+    value->kind = CMDBM_ValuePlain;
+    return icsr->connref->modif->CursorGetValue(icsr->cursor, index, value);
+}
+
+CMDBM_STATIC CMJsonValueType CMDBM_CursorGetColumnType(
+        CMDBM_Cursor *cursor, uint32_t index)
+{
+    CMDBM_Cursor_Internal *icsr = (CMDBM_Cursor_Internal*)cursor;
+    // unknown type, values must be examined.
+    if (!icsr->connref->modif->CursorColumnType)
+        return CMJsonValueNull;
+    return icsr->connref->modif->CursorColumnType(icsr->cursor, index);
+}
+
+CMDBM_STATIC int64_t CMDBM_CursorReadLob(
+        CMDBM_Cursor *cursor, uint32_t index, CMBool restart,
+        void *buf, size_t size)
+{
+    CMDBM_Cursor_Internal *icsr = (CMDBM_Cursor_Internal*)cursor;
+    if (!icsr->connref->modif->CursorReadLob) {
+        CMLogErrorS("lob streaming is not supported by this database module.");
+        return -1;
+    }
+    return icsr->connref->modif->CursorReadLob(
+                icsr->cursor, index, restart, buf, size);
+}
+
+CMDBM_STATIC CMBool CMDBM_CursorHasFailed(
+        CMDBM_Cursor *cursor)
+{
+    CMDBM_Cursor_Internal *icsr = (CMDBM_Cursor_Internal*)cursor;
+    if (!icsr->connref->modif->CursorFailed)
+        return CMFalse;
+    return icsr->connref->modif->CursorFailed(icsr->cursor);
+}
+
 CMDBM_STATIC CMDBM_Cursor *CMDBM_ConnectionOpenCursor(
         CMDBM_Connection *conn,
         CMUTIL_String *query,
@@ -91,12 +165,22 @@ CMDBM_STATIC CMDBM_Cursor *CMDBM_ConnectionOpenCursor(
         CMUTIL_JsonObject *outs)
 {
     CMDBM_Connection_Internal *iconn = (CMDBM_Connection_Internal*)conn;
+    CMDBM_Cursor_Internal *res = NULL;
     void *csr = iconn->modif->OpenCursor(
                 iconn->initres, iconn->connection, query, binds, outs);
-    CMDBM_Cursor_Internal *res = CMAlloc(sizeof(CMDBM_Cursor_Internal));
+    if (csr == NULL)
+        return NULL;
+    res = CMAlloc(sizeof(CMDBM_Cursor_Internal));
     memset(res, 0x0, sizeof(CMDBM_Cursor_Internal));
     res->base.GetNext = CMDBM_CursorGetNext;
     res->base.Close = CMDBM_CursorClose;
+    res->base.GetColumnCount = CMDBM_CursorGetColumnCount;
+    res->base.GetColumnName = CMDBM_CursorGetColumnName;
+    res->base.Fetch = CMDBM_CursorFetch;
+    res->base.GetValue = CMDBM_CursorGetValue;
+    res->base.GetColumnType = CMDBM_CursorGetColumnType;
+    res->base.ReadLob = CMDBM_CursorReadLob;
+    res->base.HasFailed = CMDBM_CursorHasFailed;
     res->connref = iconn;
     res->cursor = csr;
     return (CMDBM_Cursor*)res;
@@ -154,6 +238,86 @@ CMDBM_STATIC void CMDBM_ConnectionRollback(CMDBM_Connection *conn)
     iconn->modif->RollbackTransaction(iconn->initres, iconn->connection);
 }
 
+CMDBM_STATIC int CMDBM_ConnectionCopyIn(
+        CMDBM_Connection *conn,
+        const char *table,
+        CMUTIL_StringArray *columns,
+        CMUTIL_JsonArray *rows,
+        void *udata,
+        CMBool (*rowcb)(CMDBM_CopyRow*, uint32_t, void*))
+{
+    CMDBM_Connection_Internal *iconn = (CMDBM_Connection_Internal*)conn;
+    if (!iconn->modif->CopyIn) {
+        CMLogErrorS("bulk load is not supported by this database module.");
+        return -1;
+    }
+    return iconn->modif->CopyIn(iconn->initres, iconn->connection,
+                                table, columns, rows, udata, rowcb);
+}
+
+CMDBM_STATIC int CMDBM_ConnectionCopyOut(
+        CMDBM_Connection *conn,
+        CMUTIL_String *query,
+        CMUTIL_JsonArray *binds,
+        CMDBM_CopyFormat format,
+        void *udata,
+        CMBool (*sink)(const char*, size_t, void*))
+{
+    CMDBM_Connection_Internal *iconn = (CMDBM_Connection_Internal*)conn;
+    if (!iconn->modif->CopyOut) {
+        CMLogErrorS("bulk export is not supported by this database module.");
+        return -1;
+    }
+    return iconn->modif->CopyOut(iconn->initres, iconn->connection,
+                                 query, binds, format, udata, sink);
+}
+
+CMDBM_STATIC void CMDBM_ConnectionSetFetchSize(
+        CMDBM_Connection *conn,
+        uint32_t rows)
+{
+    CMDBM_Connection_Internal *iconn = (CMDBM_Connection_Internal*)conn;
+    // fetch size is only a hint, modules without support ignore it.
+    if (iconn->modif->SetFetchSize)
+        iconn->modif->SetFetchSize(iconn->initres, iconn->connection, rows);
+}
+
+CMDBM_STATIC int CMDBM_ConnectionExecuteLob(
+        CMDBM_Connection *conn,
+        CMUTIL_String *query,
+        CMUTIL_JsonArray *binds,
+        CMUTIL_JsonObject *outs,
+        CMDBM_LobSource **lobs)
+{
+    CMDBM_Connection_Internal *iconn = (CMDBM_Connection_Internal*)conn;
+    if (!iconn->modif->ExecuteLob) {
+        CMLogErrorS("lob streaming is not supported by this database module.");
+        return -1;
+    }
+    return iconn->modif->ExecuteLob(iconn->initres, iconn->connection,
+                                    query, binds, outs, lobs);
+}
+
+CMDBM_STATIC CMBool CMDBM_ConnectionPing(CMDBM_Connection *conn)
+{
+    CMDBM_Connection_Internal *iconn = (CMDBM_Connection_Internal*)conn;
+    return iconn->modif->PingConnection(iconn->initres, iconn->connection);
+}
+
+CMDBM_STATIC void CMDBM_ConnectionThreadInit(CMDBM_Connection *conn)
+{
+    CMDBM_Connection_Internal *iconn = (CMDBM_Connection_Internal*)conn;
+    if (iconn->modif->ThreadInit)
+        iconn->modif->ThreadInit(iconn->initres);
+}
+
+CMDBM_STATIC void CMDBM_ConnectionThreadEnd(CMDBM_Connection *conn)
+{
+    CMDBM_Connection_Internal *iconn = (CMDBM_Connection_Internal*)conn;
+    if (iconn->modif->ThreadEnd)
+        iconn->modif->ThreadEnd(iconn->initres);
+}
+
 static CMDBM_Connection g_cmdbm_connection={
     CMDBM_ConnectionGetBindString,
     CMDBM_ConnectionGetQuery,
@@ -167,7 +331,14 @@ static CMDBM_Connection g_cmdbm_connection={
     CMDBM_ConnectionBeginTransaction,
     CMDBM_ConnectionEndTransaction,
     CMDBM_ConnectionCommit,
-    CMDBM_ConnectionRollback
+    CMDBM_ConnectionRollback,
+    CMDBM_ConnectionCopyIn,
+    CMDBM_ConnectionCopyOut,
+    CMDBM_ConnectionSetFetchSize,
+    CMDBM_ConnectionExecuteLob,
+    CMDBM_ConnectionPing,
+    CMDBM_ConnectionThreadInit,
+    CMDBM_ConnectionThreadEnd
 };
 
 CMDBM_Connection *CMDBM_ConnectionCreate(CMDBM_DatabaseEx *db, void *rawconn)
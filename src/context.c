@@ -108,6 +108,58 @@ CMDBM_STATIC CMBool CMDBM_ContextParsePoolConfig(
                     (uint32_t)CMCall(pcfg, GetLong, "pinginterval");
         else
             poolconf->pingterm = 30;
+        if (CMCall(pcfg, Get, "pingtest"))
+            poolconf->pingtest = CMCall(pcfg, GetBoolean, "pingtest");
+        else
+            poolconf->pingtest = CMTrue;
+        if (CMCall(pcfg, Get, "testonborrow"))
+            poolconf->testonborrow =
+                    CMCall(pcfg, GetBoolean, "testonborrow");
+        else
+            poolconf->testonborrow = CMTrue;
+        if (CMCall(pcfg, Get, "testidle"))
+            poolconf->testidle = (uint32_t)CMCall(pcfg, GetLong, "testidle");
+        else
+            poolconf->testidle = 1000;
+        if (CMCall(pcfg, Get, "maxlifetime"))
+            poolconf->maxlifetime =
+                    (uint32_t)CMCall(pcfg, GetLong, "maxlifetime");
+        if (CMCall(pcfg, Get, "idletimeout"))
+            poolconf->idletimeout =
+                    (uint32_t)CMCall(pcfg, GetLong, "idletimeout");
+        if (CMCall(pcfg, Get, "minidle"))
+            poolconf->minidle = (uint32_t)CMCall(pcfg, GetLong, "minidle");
+        if (CMCall(pcfg, Get, "mincount"))
+            poolconf->mincnt = (uint32_t)CMCall(pcfg, GetLong, "mincount");
+        if (CMCall(pcfg, Get, "targetwait"))
+            poolconf->targetwait =
+                    (uint32_t)CMCall(pcfg, GetLong, "targetwait");
+        if (CMCall(pcfg, Get, "targetpercentile"))
+            poolconf->targetpct =
+                    (uint32_t)CMCall(pcfg, GetLong, "targetpercentile");
+        if (CMCall(pcfg, Get, "threadcache"))
+            poolconf->threadcache =
+                    (uint32_t)CMCall(pcfg, GetLong, "threadcache");
+        if (CMCall(pcfg, Get, "checkouttimeout"))
+            poolconf->checkouttimeout =
+                    (uint32_t)CMCall(pcfg, GetLong, "checkouttimeout");
+        else
+            poolconf->checkouttimeout = 5000;
+        if (CMCall(pcfg, Get, "breakerthreshold"))
+            poolconf->breakerthreshold =
+                    (uint32_t)CMCall(pcfg, GetLong, "breakerthreshold");
+        else
+            poolconf->breakerthreshold = 5;
+        if (CMCall(pcfg, Get, "breakerbackoff"))
+            poolconf->breakerbackoff =
+                    (uint32_t)CMCall(pcfg, GetLong, "breakerbackoff");
+        else
+            poolconf->breakerbackoff = 1000;
+        if (CMCall(pcfg, Get, "breakermaxbackoff"))
+            poolconf->breakermaxbackoff =
+                    (uint32_t)CMCall(pcfg, GetLong, "breakermaxbackoff");
+        else
+            poolconf->breakermaxbackoff = 60000;
         if (testsql)
             poolconf->testsql = CMStrdup(CMCall(testsql, GetCString));
         else
@@ -199,6 +251,13 @@ CMDBM_STATIC CMBool CMDBM_ContextParseDatabase(
         pconf->initcnt = 5;
         pconf->maxcnt = 20;
         pconf->pingterm = 30;
+        pconf->pingtest = CMTrue;
+        pconf->testonborrow = CMTrue;
+        pconf->testidle = 1000;
+        pconf->checkouttimeout = 5000;
+        pconf->breakerthreshold = 5;
+        pconf->breakerbackoff = 1000;
+        pconf->breakermaxbackoff = 60000;
         if (testsql)
             pconf->testsql = CMStrdup(CMCall(testsql, GetCString));
         else
@@ -214,6 +273,54 @@ CMDBM_STATIC CMBool CMDBM_ContextParseDatabase(
     if (CMCall(pcfg, Get, "pinginterval"))
         pconf->pingterm =(uint32_t)CMCall(pcfg, GetLong, "pinginterval");
 
+    if (CMCall(pcfg, Get, "pingtest"))
+        pconf->pingtest = CMCall(pcfg, GetBoolean, "pingtest");
+
+    if (CMCall(pcfg, Get, "testonborrow"))
+        pconf->testonborrow = CMCall(pcfg, GetBoolean, "testonborrow");
+
+    if (CMCall(pcfg, Get, "testidle"))
+        pconf->testidle = (uint32_t)CMCall(pcfg, GetLong, "testidle");
+
+    if (CMCall(pcfg, Get, "maxlifetime"))
+        pconf->maxlifetime = (uint32_t)CMCall(pcfg, GetLong, "maxlifetime");
+
+    if (CMCall(pcfg, Get, "idletimeout"))
+        pconf->idletimeout = (uint32_t)CMCall(pcfg, GetLong, "idletimeout");
+
+    if (CMCall(pcfg, Get, "minidle"))
+        pconf->minidle = (uint32_t)CMCall(pcfg, GetLong, "minidle");
+
+    if (CMCall(pcfg, Get, "mincount"))
+        pconf->mincnt = (uint32_t)CMCall(pcfg, GetLong, "mincount");
+
+    if (CMCall(pcfg, Get, "targetwait"))
+        pconf->targetwait = (uint32_t)CMCall(pcfg, GetLong, "targetwait");
+
+    if (CMCall(pcfg, Get, "targetpercentile"))
+        pconf->targetpct =
+                (uint32_t)CMCall(pcfg, GetLong, "targetpercentile");
+
+    if (CMCall(pcfg, Get, "threadcache"))
+        pconf->threadcache =
+                (uint32_t)CMCall(pcfg, GetLong, "threadcache");
+
+    if (CMCall(pcfg, Get, "checkouttimeout"))
+        pconf->checkouttimeout =
+                (uint32_t)CMCall(pcfg, GetLong, "checkouttimeout");
+
+    if (CMCall(pcfg, Get, "breakerthreshold"))
+        pconf->breakerthreshold =
+                (uint32_t)CMCall(pcfg, GetLong, "breakerthreshold");
+
+    if (CMCall(pcfg, Get, "breakerbackoff"))
+        pconf->breakerbackoff =
+                (uint32_t)CMCall(pcfg, GetLong, "breakerbackoff");
+
+    if (CMCall(pcfg, Get, "breakermaxbackoff"))
+        pconf->breakermaxbackoff =
+                (uint32_t)CMCall(pcfg, GetLong, "breakermaxbackoff");
+
     if (CMCall(dcfg, Get, "params")) {
         CMUTIL_Json *json = CMCall(dcfg, Get, "params");
         param = (CMUTIL_JsonObject*)CMCall(json, Clone);
@@ -455,11 +562,23 @@ CMDBM_STATIC CMDBM_DatabaseEx *CMDBM_ContextGetDatabase(
     return res;
 }
 
+CMDBM_STATIC CMBool CMDBM_ContextGetPoolStats(
+        CMDBM_Context *ctx, const char *dbid, CMDBM_PoolStats *stats)
+{
+    CMDBM_DatabaseEx *db =
+            CMDBM_ContextGetDatabase((CMDBM_ContextEx*)ctx, dbid);
+    if (db == NULL)
+        return CMFalse;
+    CMCall(db, GetPoolStats, stats);
+    return CMTrue;
+}
+
 static CMDBM_ContextEx g_cmdbm_context = {
     {
         CMDBM_ContextAddDatabase,
         CMDBM_ContextGetSession,
-        CMDBM_ContextDestroy
+        CMDBM_ContextDestroy,
+        CMDBM_ContextGetPoolStats
     },
     CMDBM_ContextGetDatabase
 };
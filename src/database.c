@@ -4,10 +4,29 @@
 CMUTIL_LogDefine("cmdbm.database")
 
 static CMUTIL_Map *g_cmdbm_dbms_interfaces = NULL;
+static CMUTIL_Map *g_cmdbm_struct_types = NULL;
+static CMUTIL_Mutex *g_cmdbm_struct_mtx = NULL;
+
+CMDBM_STATIC void CMDBM_StructTypeDestroy(void *data)
+{
+    CMDBM_StructType *stype = (CMDBM_StructType*)data;
+    if (stype) {
+        uint32_t i;
+        for (i=0; i<stype->count; i++)
+            CMFree((char*)stype->fields[i].name);
+        if (stype->fields) CMFree(stype->fields);
+        if (stype->name) CMFree(stype->name);
+        CMFree(stype);
+    }
+}
 
 void CMDBM_DatabaseInit()
 {
     g_cmdbm_dbms_interfaces = CMUTIL_MapCreate();
+    // looked up by binders on any thread, types live until clear.
+    g_cmdbm_struct_types = CMUTIL_MapCreateEx(
+                32, CMTrue, CMDBM_StructTypeDestroy, 0.75f);
+    g_cmdbm_struct_mtx = CMUTIL_MutexCreate();
 
 #if defined(CMDBM_ODBC)
     CMCall(g_cmdbm_dbms_interfaces, Put, "ODBC", &g_cmdbm_odbc_interface, NULL);
@@ -35,6 +54,14 @@ void CMDBM_DatabaseClear()
         CMCall(g_cmdbm_dbms_interfaces, Destroy);
         g_cmdbm_dbms_interfaces = NULL;
     }
+    if (g_cmdbm_struct_types) {
+        CMCall(g_cmdbm_struct_types, Destroy);
+        g_cmdbm_struct_types = NULL;
+    }
+    if (g_cmdbm_struct_mtx) {
+        CMCall(g_cmdbm_struct_mtx, Destroy);
+        g_cmdbm_struct_mtx = NULL;
+    }
 }
 
 CMBool CMDBM_RegisterDBMS(const char *dbmskey, CMDBM_ModuleInterface *modif)
@@ -49,6 +76,76 @@ CMDBM_ModuleInterface *CMDBM_GetDBMSInterface(const char *dbmskey)
         g_cmdbm_dbms_interfaces, Get, dbmskey);
 }
 
+// width binder writes for field type, zero if any size fits.
+CMDBM_STATIC size_t CMDBM_StructFieldWidth(CMDBM_FieldType type)
+{
+    switch (type) {
+    case CMDBM_FieldInt:        return sizeof(int32_t);
+    case CMDBM_FieldLong:       return sizeof(int64_t);
+    case CMDBM_FieldDouble:     return sizeof(double);
+    case CMDBM_FieldBoolean:    return sizeof(CMBool);
+    case CMDBM_FieldStringPtr:  return sizeof(char*);
+    default:                    return 0;
+    }
+}
+
+CMBool CMDBM_RegisterStruct(
+        const char *name, size_t size,
+        const CMDBM_StructField *fields, uint32_t count)
+{
+    uint32_t i;
+    CMBool res = CMFalse;
+    CMDBM_StructType *stype = NULL;
+    if (!name || !fields || count == 0) {
+        CMLogError("invalid struct descriptor.");
+        return CMFalse;
+    }
+    for (i=0; i<count; i++) {
+        size_t width = CMDBM_StructFieldWidth(fields[i].type);
+        if (fields[i].name == NULL ||
+                fields[i].offset > size ||
+                fields[i].size > size - fields[i].offset) {
+            CMLogError("invalid field %u of struct %s.", i, name);
+            return CMFalse;
+        }
+        // values are written with the width of the C type, not 'size'.
+        if ((width > 0 && fields[i].size != width) ||
+                (fields[i].type == CMDBM_FieldString &&
+                 fields[i].size == 0) ||
+                fields[i].type > CMDBM_FieldStringPtr) {
+            CMLogError("field %s of struct %s has size %u, "
+                       "which does not fit its type.",
+                       fields[i].name, name, (uint32_t)fields[i].size);
+            return CMFalse;
+        }
+    }
+    // binders keep pointers into registered types, they are never replaced.
+    CMCall(g_cmdbm_struct_mtx, Lock);
+    if (CMCall(g_cmdbm_struct_types, Get, name) != NULL) {
+        CMLogError("struct %s is registered already.", name);
+        goto ENDPOINT;
+    }
+    stype = CMAlloc(sizeof(CMDBM_StructType));
+    memset(stype, 0x0, sizeof(CMDBM_StructType));
+    stype->name = CMStrdup(name);
+    stype->size = size;
+    stype->count = count;
+    stype->fields = CMAlloc(sizeof(CMDBM_StructField) * count);
+    memcpy(stype->fields, fields, sizeof(CMDBM_StructField) * count);
+    for (i=0; i<count; i++)
+        stype->fields[i].name = CMStrdup(fields[i].name);
+    CMCall(g_cmdbm_struct_types, Put, name, stype, NULL);
+    res = CMTrue;
+ENDPOINT:
+    CMCall(g_cmdbm_struct_mtx, Unlock);
+    return res;
+}
+
+CMDBM_StructType *CMDBM_GetStructType(const char *name)
+{
+    return (CMDBM_StructType*)CMCall(g_cmdbm_struct_types, Get, name);
+}
+
 typedef struct CMDBM_MapperFile {
     CMUTIL_XmlNode      *node;
     time_t              lastupdt;
@@ -81,11 +178,12 @@ typedef struct CMDBM_Database_Internal {
     CMUTIL_Map              *mfsets;
     CMDBM_PoolConfig        *poolconf;
     CMUTIL_TimerTask        *monitor;
-    CMUTIL_Pool             *connpool;
+    CMDBM_Pool              *connpool;
     CMUTIL_JsonObject       *params;
     CMUTIL_String           *testqry;
     int                     minterval;
-    int                     dummy_padder;
+    uint32_t                fetchsize;
+    size_t                  resultmem;
 } CMDBM_Database_Internal;
 
 CMDBM_STATIC CMDBM_PoolConfig *CMDBM_PoolConfigClone(CMDBM_PoolConfig *pconf)
@@ -330,8 +428,10 @@ CMDBM_STATIC CMBool CMDBM_DatabasePoolTestProc(
 {
     CMDBM_Database_Internal *idb = (CMDBM_Database_Internal*)data;
     CMDBM_Connection *conn = (CMDBM_Connection*)resource;
-    CMUTIL_JsonValue *val = CMCall(
-                conn, GetObject, idb->testqry, NULL, NULL);
+    CMUTIL_JsonValue *val = NULL;
+    if (idb->modif->PingConnection)
+        return CMCall(conn, Ping);
+    val = CMCall(conn, GetObject, idb->testqry, NULL, NULL);
     if (val) {
         CMUTIL_JsonDestroy(val);
         return CMTrue;
@@ -452,13 +552,13 @@ CMDBM_STATIC CMBool CMDBM_DatabaseInitialize(
     CMDBM_Database_Internal *idb = (CMDBM_Database_Internal*)db;
     idb->pgcs = CMStrdup(pgcs);
     idb->initres = idb->modif->Initialize(idb->dbcs, idb->pgcs);
-    idb->connpool = CMUTIL_PoolCreate(
-                (int)idb->poolconf->initcnt,
-                (int)idb->poolconf->maxcnt,
+    idb->connpool = CMDBM_PoolCreate(
+                idb->sourceid,
+                idb->poolconf,
                 CMDBM_DatabasePoolCreateProc,
                 CMDBM_DatabasePoolDestroyProc,
                 CMDBM_DatabasePoolTestProc,
-                30, CMTrue, idb, timer);
+                idb, timer);
 
     // do initial mapper load
     CMDBM_DatabaseMapperReloader(idb);
@@ -512,13 +612,16 @@ CMDBM_STATIC CMUTIL_XmlNode *CMDBM_DatabaseGetQuery(
 }
 
 CMDBM_STATIC CMDBM_Connection *CMDBM_DatabaseGetConnection(
-        CMDBM_DatabaseEx *db)
+        CMDBM_DatabaseEx *db, long millisec)
 {
     CMDBM_Database_Internal *idb = (CMDBM_Database_Internal*)db;
-    CMDBM_Connection *res = CMCall(idb->connpool, CheckOut, 5000);
+    CMDBM_Connection *res = NULL;
+    if (millisec < 0)
+        millisec = (long)idb->poolconf->checkouttimeout;
+    res = CMDBM_PoolCheckOut(idb->connpool, millisec);
     if (res == NULL) {
-        CMLogError("cannot get connection from source '%s' in 5 seconds",
-                   idb->sourceid);
+        CMLogError("cannot get connection from source '%s' in %ld ms",
+                   idb->sourceid, millisec);
     }
     return res;
 }
@@ -527,7 +630,31 @@ CMDBM_STATIC void CMDBM_DatabaseReleaseConnection(
         CMDBM_DatabaseEx *db, CMDBM_Connection *conn)
 {
     CMDBM_Database_Internal *idb = (CMDBM_Database_Internal*)db;
-    CMCall(idb->connpool, Release, conn);
+    CMDBM_PoolRelease(idb->connpool, conn);
+}
+
+CMDBM_STATIC uint32_t CMDBM_DatabaseGetFetchSize(
+        CMDBM_DatabaseEx *db)
+{
+    CMDBM_Database_Internal *idb = (CMDBM_Database_Internal*)db;
+    return idb->fetchsize;
+}
+
+CMDBM_STATIC size_t CMDBM_DatabaseGetResultMemory(
+        CMDBM_DatabaseEx *db)
+{
+    CMDBM_Database_Internal *idb = (CMDBM_Database_Internal*)db;
+    return idb->resultmem;
+}
+
+CMDBM_STATIC void CMDBM_DatabaseGetPoolStats(
+        CMDBM_DatabaseEx *db, CMDBM_PoolStats *stats)
+{
+    CMDBM_Database_Internal *idb = (CMDBM_Database_Internal*)db;
+    if (idb->connpool)
+        CMDBM_PoolGetStats(idb->connpool, stats);
+    else
+        memset(stats, 0x0, sizeof(CMDBM_PoolStats));
 }
 
 CMDBM_STATIC void CMDBM_DatabaseDestroy(
@@ -542,7 +669,7 @@ CMDBM_STATIC void CMDBM_DatabaseDestroy(
         if (idb->mfiles) CMCall(idb->mfiles, Destroy);
         if (idb->mfsets) CMCall(idb->mfsets, Destroy);
         if (idb->monitor) CMCall(idb->monitor, Cancel);
-        if (idb->connpool) CMCall(idb->connpool, Destroy);
+        if (idb->connpool) CMDBM_PoolDestroy(idb->connpool);
         if (idb->params) CMUTIL_JsonDestroy(idb->params);
         if (idb->testqry) CMCall(idb->testqry, Destroy);
         if (idb->poolconf) CMDBM_PoolConfigDestroy(idb->poolconf);
@@ -581,7 +708,10 @@ static CMDBM_DatabaseEx g_cmdbm_databse = {
     CMDBM_DatabaseGetConnection,
     CMDBM_DatabaseReleaseConnection,
     CMDBM_DatabaseLockQueryItem,
-    CMDBM_DatabaseUnlockQueryItem
+    CMDBM_DatabaseUnlockQueryItem,
+    CMDBM_DatabaseGetFetchSize,
+    CMDBM_DatabaseGetResultMemory,
+    CMDBM_DatabaseGetPoolStats
 };
 
 CMDBM_Database *CMDBM_DatabaseCreateCustom(
@@ -605,6 +735,12 @@ CMDBM_Database *CMDBM_DatabaseCreateCustom(
     res->queries = CMUTIL_MapCreate();
     res->poolconf = CMDBM_PoolConfigClone(poolconf);
     res->params = (CMUTIL_JsonObject*)CMCall(&(params->parent), Clone);
+    // default rows per fetch round trip, zero means module default.
+    if (CMCall(res->params, Get, "fetchsize"))
+        res->fetchsize = (uint32_t)CMCall(res->params, GetLong, "fetchsize");
+    // memory budget of a result set in bytes, zero means no limit.
+    if (CMCall(res->params, Get, "resultmemory"))
+        res->resultmem = (size_t)CMCall(res->params, GetLong, "resultmemory");
     res->rwlock = CMUTIL_RWLockCreate();
     res->testqry = CMUTIL_StringCreateEx(64, modif->GetTestQuery());
     return (CMDBM_Database*)res;
@@ -0,0 +1,251 @@
+
+#include "functions.h"
+
+#include <math.h>
+
+CMUTIL_LogDefine("cmdbm.export")
+
+// output is handed to sink in chunks of this size.
+#define CMDBM_EXPORT_BUFSZ      65536
+
+typedef struct CMDBM_ExportWriter {
+    char                buf[CMDBM_EXPORT_BUFSZ];
+    size_t              used;
+    void                *udata;
+    CMBool              (*sink)(const char*, size_t, void*);
+    CMBool              failed;
+    int                 dummy_padder;
+} CMDBM_ExportWriter;
+
+CMDBM_STATIC CMBool CMDBM_ExportFlush(CMDBM_ExportWriter *w)
+{
+    // after failure, output is dropped.
+    if (!w->failed && w->used > 0) {
+        if (!w->sink(w->buf, w->used, w->udata))
+            w->failed = CMTrue;
+    }
+    w->used = 0;
+    return !w->failed;
+}
+
+CMDBM_STATIC void CMDBM_ExportWrite(
+        CMDBM_ExportWriter *w, const char *data, size_t size)
+{
+    while (size > 0 && !w->failed) {
+        size_t avail = CMDBM_EXPORT_BUFSZ - w->used;
+        if (avail == 0) {
+            CMDBM_ExportFlush(w);
+            continue;
+        }
+        if (avail > size)
+            avail = size;
+        memcpy(w->buf + w->used, data, avail);
+        w->used += avail;
+        data += avail;
+        size -= avail;
+    }
+}
+
+CMDBM_STATIC void CMDBM_ExportPutChar(CMDBM_ExportWriter *w, char c)
+{
+    if (w->used == CMDBM_EXPORT_BUFSZ)
+        CMDBM_ExportFlush(w);
+    w->buf[w->used++] = c;
+}
+
+/*
+ * Writes 'str' escaping characters in 'special' with 'escfn'. Runs of
+ * plain characters are found with strcspn and copied at once.
+ */
+CMDBM_STATIC void CMDBM_ExportEscaped(
+        CMDBM_ExportWriter *w, const char *str, size_t len,
+        const char *special, void (*escfn)(CMDBM_ExportWriter*, char))
+{
+    const char *end = str + len;
+    while (str < end) {
+        size_t run = strcspn(str, special);
+        if (str + run > end)
+            run = (size_t)(end - str);
+        CMDBM_ExportWrite(w, str, run);
+        str += run;
+        // embedded terminator also stops strcspn, it goes to escfn too.
+        if (str < end)
+            escfn(w, *str++);
+    }
+}
+
+CMDBM_STATIC void CMDBM_ExportEscCSV(CMDBM_ExportWriter *w, char c)
+{
+    if (c == '"')
+        CMDBM_ExportPutChar(w, '"');
+    CMDBM_ExportPutChar(w, c);
+}
+
+CMDBM_STATIC void CMDBM_ExportEscTSV(CMDBM_ExportWriter *w, char c)
+{
+    switch (c) {
+    case '\t': CMDBM_ExportWrite(w, "\\t", 2); break;
+    case '\n': CMDBM_ExportWrite(w, "\\n", 2); break;
+    case '\r': CMDBM_ExportWrite(w, "\\r", 2); break;
+    case '\\': CMDBM_ExportWrite(w, "\\\\", 2); break;
+    default: break;
+    }
+}
+
+CMDBM_STATIC void CMDBM_ExportEscJSON(CMDBM_ExportWriter *w, char c)
+{
+    char ubuf[8];
+    switch (c) {
+    case '"':  CMDBM_ExportWrite(w, "\\\"", 2); break;
+    case '\\': CMDBM_ExportWrite(w, "\\\\", 2); break;
+    case '\n': CMDBM_ExportWrite(w, "\\n", 2); break;
+    case '\r': CMDBM_ExportWrite(w, "\\r", 2); break;
+    case '\t': CMDBM_ExportWrite(w, "\\t", 2); break;
+    default:
+        sprintf(ubuf, "\\u%04x", (unsigned)(unsigned char)c);
+        CMDBM_ExportWrite(w, ubuf, 6);
+    }
+}
+
+static const char g_cmdbm_export_csvspecial[] = "\",\r\n";
+static const char g_cmdbm_export_tsvspecial[] = "\t\r\n\\";
+static const char g_cmdbm_export_jsonspecial[] =
+        "\"\\\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"
+        "\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f";
+
+CMDBM_STATIC void CMDBM_ExportText(
+        CMDBM_ExportWriter *w, CMDBM_ExportFormat format,
+        const char *str, size_t len)
+{
+    switch (format) {
+    case CMDBM_ExportCSV:
+        // quote only when needed.
+        if (strcspn(str, g_cmdbm_export_csvspecial) < len) {
+            CMDBM_ExportPutChar(w, '"');
+            CMDBM_ExportEscaped(w, str, len, "\"", CMDBM_ExportEscCSV);
+            CMDBM_ExportPutChar(w, '"');
+        } else {
+            CMDBM_ExportWrite(w, str, len);
+        }
+        break;
+    case CMDBM_ExportTSV:
+        CMDBM_ExportEscaped(w, str, len,
+                            g_cmdbm_export_tsvspecial, CMDBM_ExportEscTSV);
+        break;
+    case CMDBM_ExportNDJSON:
+        CMDBM_ExportPutChar(w, '"');
+        CMDBM_ExportEscaped(w, str, len,
+                            g_cmdbm_export_jsonspecial, CMDBM_ExportEscJSON);
+        CMDBM_ExportPutChar(w, '"');
+        break;
+    }
+}
+
+CMDBM_STATIC void CMDBM_ExportValue(
+        CMDBM_ExportWriter *w, CMDBM_ExportFormat format,
+        const CMDBM_ColumnValue *val)
+{
+    char nbuf[64];
+    int nlen = 0;
+    switch (val->type) {
+    case CMJsonValueLong:
+        nlen = sprintf(nbuf, "%lld", (long long)val->u.lval);
+        CMDBM_ExportWrite(w, nbuf, (size_t)nlen);
+        break;
+    case CMJsonValueDouble:
+        if (format == CMDBM_ExportNDJSON && !isfinite(val->u.dval)) {
+            // NaN and infinities have no json representation.
+            CMDBM_ExportWrite(w, "null", 4);
+            break;
+        }
+        nlen = sprintf(nbuf, "%.17g", val->u.dval);
+        CMDBM_ExportWrite(w, nbuf, (size_t)nlen);
+        break;
+    case CMJsonValueBoolean:
+        if (val->u.bval)
+            CMDBM_ExportWrite(w, "true", 4);
+        else
+            CMDBM_ExportWrite(w, "false", 5);
+        break;
+    case CMJsonValueString:
+        CMDBM_ExportText(w, format, val->u.sval, val->length);
+        break;
+    default:
+        // null is empty field in CSV, '\N' in TSV.
+        if (format == CMDBM_ExportNDJSON)
+            CMDBM_ExportWrite(w, "null", 4);
+        else if (format == CMDBM_ExportTSV)
+            CMDBM_ExportWrite(w, "\\N", 2);
+    }
+}
+
+int CMDBM_ExportCursor(
+        CMDBM_Cursor *cursor, CMDBM_ExportFormat format,
+        void *udata, CMBool (*sink)(const char*, size_t, void*))
+{
+    int res = 0;
+    uint32_t i, colcnt = CMCall(cursor, GetColumnCount);
+    char delim = format == CMDBM_ExportTSV? '\t':',';
+    const char **names = NULL;
+    CMDBM_ExportWriter *w = NULL;
+
+    if (colcnt == 0)
+        return -1;
+    w = CMAlloc(sizeof(CMDBM_ExportWriter));
+    memset(w, 0x0, sizeof(CMDBM_ExportWriter));
+    w->udata = udata;
+    w->sink = sink;
+    names = CMAlloc(sizeof(char*) * colcnt);
+    for (i=0; i<colcnt; i++) {
+        names[i] = CMCall(cursor, GetColumnName, i);
+        if (names[i] == NULL) names[i] = "";
+    }
+
+    // header line for delimited formats.
+    if (format != CMDBM_ExportNDJSON) {
+        for (i=0; i<colcnt; i++) {
+            if (i > 0) CMDBM_ExportPutChar(w, delim);
+            CMDBM_ExportText(w, format, names[i], strlen(names[i]));
+        }
+        CMDBM_ExportPutChar(w, '\n');
+    }
+
+    while (!w->failed && CMCall(cursor, Fetch)) {
+        if (format == CMDBM_ExportNDJSON)
+            CMDBM_ExportPutChar(w, '{');
+        for (i=0; i<colcnt; i++) {
+            CMDBM_ColumnValue val;
+            if (!CMCall(cursor, GetValue, i, &val)) {
+                CMLogErrorS("cannot read column %s of row %d.",
+                            names[i], res);
+                res = -1;
+                goto ENDPOINT;
+            }
+            if (format == CMDBM_ExportNDJSON) {
+                if (i > 0) CMDBM_ExportPutChar(w, ',');
+                CMDBM_ExportText(w, format, names[i], strlen(names[i]));
+                CMDBM_ExportPutChar(w, ':');
+            } else if (i > 0) {
+                CMDBM_ExportPutChar(w, delim);
+            }
+            CMDBM_ExportValue(w, format, &val);
+        }
+        if (format == CMDBM_ExportNDJSON)
+            CMDBM_ExportPutChar(w, '}');
+        CMDBM_ExportPutChar(w, '\n');
+        res++;
+    }
+    if (!w->failed && CMCall(cursor, HasFailed)) {
+        CMLogErrorS("fetching row %d failed.", res);
+        res = -1;
+        goto ENDPOINT;
+    }
+    if (!CMDBM_ExportFlush(w)) {
+        CMLogErrorS("export aborted by sink after %d rows.", res);
+        res = -1;
+    }
+ENDPOINT:
+    CMFree(names);
+    CMFree(w);
+    return res;
+}
@@ -21,6 +21,45 @@
 # define CMDBM_STATIC    static
 #endif
 
+// atomic operations on 32bit, 64bit and pointer words,
+// loads acquire and stores release.
+#if defined(MSWIN)
+# include <windows.h>
+# define CMDBM_AtomicLoad(p)         \
+    (uint32_t)InterlockedCompareExchange((volatile LONG*)(p), 0, 0)
+# define CMDBM_AtomicStore(p, v)     \
+    InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+# define CMDBM_AtomicAdd(p, v)       \
+    (uint32_t)InterlockedExchangeAdd((volatile LONG*)(p), (LONG)(v))
+# define CMDBM_AtomicCAS(p, e, d)    \
+    ((uint32_t)InterlockedCompareExchange(\
+        (volatile LONG*)(p), (LONG)(d), (LONG)(e)) == (uint32_t)(e))
+# define CMDBM_AtomicLoad64(p)       \
+    (uint64_t)InterlockedCompareExchange64((volatile LONG64*)(p), 0, 0)
+# define CMDBM_AtomicCAS64(p, e, d)  \
+    ((uint64_t)InterlockedCompareExchange64(\
+        (volatile LONG64*)(p), (LONG64)(d), (LONG64)(e)) == (uint64_t)(e))
+# define CMDBM_AtomicFence()         MemoryBarrier()
+# define CMDBM_AtomicSwapPtr(p, v)   \
+    InterlockedExchangePointer((PVOID volatile*)(p), (PVOID)(v))
+#else
+# define CMDBM_AtomicLoad(p)         __atomic_load_n(p, __ATOMIC_ACQUIRE)
+# define CMDBM_AtomicStore(p, v)     __atomic_store_n(p, v, __ATOMIC_RELEASE)
+# define CMDBM_AtomicAdd(p, v)       \
+    __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL)
+# define CMDBM_AtomicCAS(p, e, d)    __extension__({\
+    uint32_t cmdbm_exp__ = (e);\
+    __atomic_compare_exchange_n(p, &cmdbm_exp__, d, 0,\
+        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);})
+# define CMDBM_AtomicLoad64(p)       __atomic_load_n(p, __ATOMIC_ACQUIRE)
+# define CMDBM_AtomicCAS64(p, e, d)  __extension__({\
+    uint64_t cmdbm_exp64__ = (e);\
+    __atomic_compare_exchange_n(p, &cmdbm_exp64__, d, 0,\
+        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);})
+# define CMDBM_AtomicFence()         __atomic_thread_fence(__ATOMIC_SEQ_CST)
+# define CMDBM_AtomicSwapPtr(p, v)   __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL)
+#endif
+
 #define CMDBM_SPACES        " \r\n\t"
 #define CMDBM_SQLDELIMS        " \r\r\n\t{}[]+%\'./():,*\"=<>@;-|!~^"
 
@@ -31,6 +70,9 @@ void CMDBM_MapperClear(void);
 void CMDBM_DatabaseInit(void);
 void CMDBM_DatabaseClear(void);
 
+void CMDBM_PoolInit(void);
+void CMDBM_PoolClear(void);
+
 CMBool CMDBM_MapperRebuildItem(
         CMUTIL_Map *queries,
         CMUTIL_XmlNode *node);
@@ -49,8 +91,219 @@ CMBool CMDBM_BuildNode(
 CMDBM_Session *CMDBM_SessionCreate(
         CMDBM_ContextEx *ctx);
 
+/*
+ * Records that bind 'index' is streamed if parameter 'key' is one of lob
+ * sources of executing statement. Returns CMTrue in that case.
+ */
+CMBool CMDBM_SessionBindLob(
+        CMDBM_Session *sess,
+        const char *key,
+        uint32_t index);
+
 CMDBM_ModuleInterface *CMDBM_GetDBMSInterface(
     const char *dbmskey);
 
+int64_t CMDBM_ValueToLong(
+        const CMDBM_ColumnValue *val);
+
+double CMDBM_ValueToDouble(
+        const CMDBM_ColumnValue *val);
+
+CMBool CMDBM_ValueToBoolean(
+        const CMDBM_ColumnValue *val);
+
+/*
+ * Fetches all rows of cursor. Rows after 'memlimit' bytes are spilled to
+ * temporary file, zero means no limit.
+ */
+CMDBM_ResultSet *CMDBM_ResultSetCreate(
+        CMDBM_Cursor *cursor,
+        size_t memlimit);
+
+CMDBM_Row *CMDBM_RowCreate(
+        CMDBM_Cursor *cursor);
+
+void CMDBM_RowDestroy(
+        CMDBM_Row *row);
+
+CMDBM_StructType *CMDBM_GetStructType(
+        const char *name);
+
+int CMDBM_ExportCursor(
+        CMDBM_Cursor *cursor,
+        CMDBM_ExportFormat format,
+        void *udata,
+        CMBool (*sink)(const char*, size_t, void*));
+
+int CMDBM_ColumnarCursor(
+        CMDBM_Cursor *cursor,
+        uint32_t batchrows,
+        void *udata,
+        CMBool (*batchcb)(const struct ArrowSchema*,
+                          struct ArrowArray*, void*));
+
+/*
+ * Iterates cursor rows while background thread fetches next batch.
+ * Background thread is the only user of 'conn' until this returns.
+ * Returns CMFalse without consuming any row if thread cannot be started.
+ */
+CMBool CMDBM_PrefetchForEach(
+        CMDBM_Connection *conn,
+        CMDBM_Cursor *cursor,
+        uint32_t batchrows,
+        void *udata,
+        CMBool (*rowcb)(CMUTIL_JsonObject*, uint32_t, void*));
+
+/*
+ * Dispatches cursor rows in batches to 'nthreads' worker threads running
+ * 'rowcb'. Optional 'commitcb' is called on calling thread for each
+ * processed row, in row order if 'ordered' is set.
+ */
+CMBool CMDBM_ParallelForEach(
+        CMDBM_Cursor *cursor,
+        uint32_t nthreads,
+        CMBool ordered,
+        void *udata,
+        CMBool (*rowcb)(CMUTIL_JsonObject*, uint32_t, void*),
+        CMBool (*commitcb)(CMUTIL_JsonObject*, uint32_t, void*));
+
+typedef struct CMDBM_StructBinder CMDBM_StructBinder;
+
+/*
+ * Resolves cursor columns to struct fields with 'resultMap' or
+ * 'resultType' attribute of query 'sqlid'. Must be called while query
+ * items of 'db' are locked.
+ */
+CMDBM_StructBinder *CMDBM_StructBinderCreate(
+        CMDBM_Cursor *cursor,
+        CMDBM_DatabaseEx *db,
+        const char *sqlid);
+
+size_t CMDBM_StructBinderGetSize(
+        CMDBM_StructBinder *binder);
+
+CMBool CMDBM_StructBinderFill(
+        CMDBM_StructBinder *binder,
+        void *item);
+
+void CMDBM_StructBinderClearItem(
+        CMDBM_StructBinder *binder,
+        void *item);
+
+void CMDBM_StructBinderDestroy(
+        CMDBM_StructBinder *binder);
+
+/*
+ * Grows 'buf' to hold at least 'need' bytes, doubling its capacity.
+ * First 'keep' bytes are preserved. Returns the (possibly new) buffer.
+ */
+void *CMDBM_BufferGrow(
+        void *buf,
+        size_t *cap,
+        size_t need,
+        size_t keep);
+
+// bytes read from lob source per driver call.
+#define CMDBM_LOB_CHUNK         (64 * 1024)
+
+// date and time parts read from driver native structures.
+typedef struct CMDBM_DateTime {
+    int         year;
+    int         month;
+    int         day;
+    int         hour;
+    int         minute;
+    int         second;
+    uint32_t    usec;
+    int32_t     tzoffset;   // minutes
+    CMBool      hastz;
+    int         dummy_padder;
+} CMDBM_DateTime;
+
+// enough for "YYYY-MM-DD HH:MM:SS.ffffff+HH:MM" with wide years.
+#define CMDBM_DATETIME_BUFSZ    48
+
+/*
+ * Writes ISO 8601 like text of 'dt' into 'buf' of CMDBM_DATETIME_BUFSZ
+ * bytes, returns text length.
+ */
+size_t CMDBM_DateTimeFormat(
+        const CMDBM_DateTime *dt,
+        char *buf);
+
+/*
+ * Sets 'value' to timestamp kind, text form is written into 'buf' of
+ * CMDBM_DATETIME_BUFSZ bytes.
+ */
+void CMDBM_DateTimeToValue(
+        const CMDBM_DateTime *dt,
+        char *buf,
+        CMDBM_ColumnValue *value);
+
+/*
+ * Marks 'value' as decimal kind with exact text, json form of value must
+ * be set by caller.
+ */
+void CMDBM_DecimalToValue(
+        const char *digits,
+        size_t length,
+        int32_t scale,
+        CMDBM_ColumnValue *value);
+
+/*
+ * Writes upper case hex text of 'data' into 'out' of 'length' * 2 + 1
+ * bytes, returns text length.
+ */
+size_t CMDBM_HexEncode(
+        const void *data,
+        size_t length,
+        char *out);
+
+// milliseconds of monotonic clock.
+int64_t CMDBM_TimeMillis(void);
+
+typedef struct CMDBM_Pool CMDBM_Pool;
+
+/*
+ * Creates resource pool named 'name' for logs, holding up to 'maxcnt'
+ * resources of 'conf',
+ * 'initcnt' of them are created at once in parallel. Idle resources are
+ * tested every 'pingterm' seconds if 'pingtest' and 'timer' is given, and
+ * on checkout if 'testonborrow'. Resources released within 'testidle'
+ * milliseconds are not tested. Idle resources past 'maxlifetime' or idle
+ * longer than 'idletimeout' are closed, and background opener keeps
+ * 'minidle' ones open. Periodic tasks of the pool run on 'timer'.
+ */
+CMDBM_Pool *CMDBM_PoolCreate(
+        const char *name,
+        const CMDBM_PoolConfig *conf,
+        void *(*createf)(void*),
+        void (*destroyf)(void*, void*),
+        CMBool (*testf)(void*, void*),
+        void *udata,
+        CMUTIL_Timer *timer);
+
+/*
+ * Takes idle resource or creates new one below maximum, waits up to
+ * 'millisec' for a release otherwise. Waiting callers are served in
+ * arrival order. Returns NULL on timeout, or at once while circuit
+ * breaker of the pool is open.
+ */
+void *CMDBM_PoolCheckOut(
+        CMDBM_Pool *pool,
+        long millisec);
+
+void CMDBM_PoolRelease(
+        CMDBM_Pool *pool,
+        void *resource);
+
+void CMDBM_PoolGetStats(
+        CMDBM_Pool *pool,
+        CMDBM_PoolStats *stats);
+
+// destroys idle resources, checked out ones must be released before.
+void CMDBM_PoolDestroy(
+        CMDBM_Pool *pool);
+
 #endif // FUNCTIONS_H__
 
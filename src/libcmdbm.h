@@ -6,6 +6,7 @@ extern "C" {
 #endif
 
 #include <libcmutils.h>
+#include <stddef.h>
 
 #ifndef CMDBM_API
 # if defined(MSWIN)
@@ -24,6 +25,151 @@ CMDBM_API const char *CMDBM_GetLibVersion(void);
 CMDBM_API void CMDBM_Init(void);
 CMDBM_API void CMDBM_Clear(void);
 
+typedef enum CMDBM_CopyFormat {
+    CMDBM_CopyText = 0,
+    CMDBM_CopyCSV,
+    CMDBM_CopyBinary
+} CMDBM_CopyFormat;
+
+/*
+ * Arrow C data interface structures, see
+ * https://arrow.apache.org/docs/format/CDataInterface.html
+ */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char          *format;
+    const char          *name;
+    const char          *metadata;
+    int64_t             flags;
+    int64_t             n_children;
+    struct ArrowSchema  **children;
+    struct ArrowSchema  *dictionary;
+    void (*release)(struct ArrowSchema*);
+    void                *private_data;
+};
+
+struct ArrowArray {
+    int64_t             length;
+    int64_t             null_count;
+    int64_t             offset;
+    int64_t             n_buffers;
+    int64_t             n_children;
+    const void          **buffers;
+    struct ArrowArray   **children;
+    struct ArrowArray   *dictionary;
+    void (*release)(struct ArrowArray*);
+    void                *private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+typedef enum CMDBM_ExportFormat {
+    CMDBM_ExportCSV = 0,
+    CMDBM_ExportTSV,
+    CMDBM_ExportNDJSON
+} CMDBM_ExportFormat;
+
+/* row writer passed to bulk load callbacks, fields are added in order. */
+typedef struct CMDBM_CopyRow CMDBM_CopyRow;
+struct CMDBM_CopyRow {
+    void (*AddLong)(
+            CMDBM_CopyRow *row,
+            int64_t value);
+    void (*AddDouble)(
+            CMDBM_CopyRow *row,
+            double value);
+    void (*AddString)(
+            CMDBM_CopyRow *row,
+            const char *value);
+    void (*AddBoolean)(
+            CMDBM_CopyRow *row,
+            CMBool value);
+    void (*AddNull)(
+            CMDBM_CopyRow *row);
+};
+
+/*
+ * source of streamed large object bind. 'read' fills at most 'size' bytes
+ * into 'buf' and returns the count, zero at end of data or -1 on failure.
+ */
+typedef struct CMDBM_LobSource {
+    const char          *name;      /* parameter bound with #{name} */
+    void                *udata;
+    int64_t             (*read)(void *buf, size_t size, void *udata);
+    CMBool              binary;     /* BLOB if CMTrue, CLOB otherwise */
+    int                 dummy_padder;
+} CMDBM_LobSource;
+
+/*
+ * sequential reader of large column value of current cursor row.
+ */
+typedef struct CMDBM_LobReader CMDBM_LobReader;
+struct CMDBM_LobReader {
+    /* returns bytes read, zero at end of value or -1 on failure. */
+    int64_t (*Read)(
+            CMDBM_LobReader     *reader,
+            void                *buf,
+            size_t              size);
+    void (*Close)(
+            CMDBM_LobReader     *reader);
+};
+
+/*
+ * native kind of column value. 'type' and 'u' of column value always
+ * hold the value as it appears in json rows, native form is in 'native'.
+ */
+typedef enum CMDBM_ValueKind {
+    CMDBM_ValuePlain = 0,
+    CMDBM_ValueTimestamp,       /* native.ts */
+    CMDBM_ValueDecimal,         /* native.dec */
+    CMDBM_ValueBinary           /* native.bin */
+} CMDBM_ValueKind;
+
+typedef struct CMDBM_Timestamp {
+    int64_t             micros;     /* microseconds since 1970-01-01 UTC */
+    int32_t             tzoffset;   /* zone offset in minutes */
+    CMBool              hastz;      /* CMFalse for local date and time */
+} CMDBM_Timestamp;
+
+typedef struct CMDBM_Decimal {
+    const char          *digits;    /* exact text, e.g. "-123.4500" */
+    size_t              length;
+    int32_t             scale;      /* digits after decimal point */
+    int                 dummy_padder;
+} CMDBM_Decimal;
+
+typedef struct CMDBM_Binary {
+    const void          *data;
+    size_t              length;
+} CMDBM_Binary;
+
+/*
+ * value of a column in current cursor row. string values point into
+ * module fetch buffers and are valid until the cursor moves.
+ */
+typedef struct CMDBM_ColumnValue {
+    CMJsonValueType     type;
+    CMDBM_ValueKind     kind;
+    size_t              length;     /* string length in bytes */
+    union {
+        int64_t         lval;
+        double          dval;
+        CMBool          bval;
+        const char      *sval;
+    } u;
+    union {
+        CMDBM_Timestamp ts;
+        CMDBM_Decimal   dec;
+        CMDBM_Binary    bin;
+    } native;
+} CMDBM_ColumnValue;
+
 typedef struct CMDBM_ModuleInterface CMDBM_ModuleInterface;
 struct CMDBM_ModuleInterface {
     void (*LibraryInit)(void);
@@ -47,6 +193,10 @@ struct CMDBM_ModuleInterface {
     CMBool (*StartTransaction)(
             void *initres,
             void *connection);
+    /*
+     * Rolls back work not committed since the last commit and returns the
+     * connection to autocommit mode.
+     */
     void (*EndTransaction)(
             void *initres,
             void *connection);
@@ -90,6 +240,75 @@ struct CMDBM_ModuleInterface {
             void *cursor);
     CMUTIL_JsonObject *(*CursorNextRow)(
             void *cursor);
+    int (*CopyIn)(
+            void *initres,
+            void *connection,
+            const char *table,
+            CMUTIL_StringArray *columns,
+            CMUTIL_JsonArray *rows,
+            void *udata,
+            CMBool (*rowcb)(CMDBM_CopyRow *row, uint32_t rownum, void *udata));
+    int (*CopyOut)(
+            void *initres,
+            void *connection,
+            CMUTIL_String *query,
+            CMUTIL_JsonArray *binds,
+            CMDBM_CopyFormat format,
+            void *udata,
+            CMBool (*sink)(const char *data, size_t size, void *udata));
+    void (*SetFetchSize)(
+            void *initres,
+            void *connection,
+            uint32_t rows);
+    uint32_t (*CursorColumnCount)(
+            void *cursor);
+    const char *(*CursorColumnName)(
+            void *cursor,
+            uint32_t index);
+    CMBool (*CursorFetch)(
+            void *cursor);
+    CMBool (*CursorGetValue)(
+            void *cursor,
+            uint32_t index,
+            CMDBM_ColumnValue *value);
+    CMJsonValueType (*CursorColumnType)(
+            void *cursor,
+            uint32_t index);
+    int64_t (*CursorReadLob)(
+            void *cursor,
+            uint32_t index,
+            CMBool restart,
+            void *buf,
+            size_t size);
+    int (*ExecuteLob)(
+            void *initres,
+            void *connection,
+            CMUTIL_String *query,
+            CMUTIL_JsonArray *binds,
+            CMUTIL_JsonObject *outs,
+            CMDBM_LobSource **lobs);     /* one per bind, NULL if plain */
+    /*
+     * Cheap liveness check used instead of test query when validating
+     * pooled connections. Optional.
+     */
+    CMBool (*PingConnection)(
+            void *initres,
+            void *connection);
+    /*
+     * Called on a library thread before and after it drives a connection
+     * opened by another thread, for client libraries which keep per
+     * thread state. Optional.
+     */
+    void (*ThreadInit)(
+            void *initres);
+    void (*ThreadEnd)(
+            void *initres);
+    /*
+     * Tells whether iteration of cursor stopped by fetch error rather than
+     * end of rows. Optional, fetch errors look like end of rows without it.
+     */
+    CMBool (*CursorFailed)(
+            void *cursor);
 };
 
 typedef struct CMDBM_PoolConfig {
@@ -99,11 +318,119 @@ typedef struct CMDBM_PoolConfig {
     uint32_t initcnt;
     uint32_t maxcnt;
     char *testsql;
+    /*
+     * milliseconds a released connection stays parked for reuse by the
+     * same thread, zero disables thread caching.
+     */
+    uint32_t threadcache;
+    /* milliseconds to wait for a connection when pool is exhausted. */
+    uint32_t checkouttimeout;
+    /*
+     * connections released within this many milliseconds are handed out
+     * and kept idle without validation.
+     */
+    uint32_t testidle;
+    /*
+     * milliseconds a connection is used before it is replaced, each one
+     * gets up to 1/8 less so they are not replaced at once. zero for no
+     * limit.
+     */
+    uint32_t maxlifetime;
+    /* milliseconds an idle connection is kept beyond 'minidle' ones. */
+    uint32_t idletimeout;
+    /*
+     * idle connections kept open. background opener is woken when idle
+     * connections drop below it, so requests do not wait for connecting.
+     */
+    uint32_t minidle;
+    /*
+     * adaptive sizing is enabled when 'targetwait' is not zero. pool size
+     * is moved between 'mincnt' and 'maxcnt' to keep 'targetpct'
+     * percentile of checkout wait under 'targetwait' milliseconds.
+     */
+    uint32_t mincnt;
+    uint32_t targetwait;
+    uint32_t targetpct;
+    /*
+     * circuit breaker opens after 'breakerthreshold' consecutive failures
+     * to connect, checkouts then fail at once. after 'breakerbackoff'
+     * milliseconds one reconnect is tried, each failed one doubles the
+     * wait up to 'breakermaxbackoff'. zero threshold disables it.
+     */
+    uint32_t breakerthreshold;
+    uint32_t breakerbackoff;
+    uint32_t breakermaxbackoff;
 } CMDBM_PoolConfig;
 
+typedef enum CMDBM_BreakerState {
+    CMDBM_BreakerClosed = 0,    /* connecting normally */
+    CMDBM_BreakerOpen,          /* failing fast until next probe */
+    CMDBM_BreakerHalfOpen       /* one reconnect is being tried */
+} CMDBM_BreakerState;
+
+/*
+ * Connection pool usage of a database. Wait times are taken from
+ * checkouts which had to queue for a connection, percentiles are upper
+ * bounds of power of two millisecond buckets.
+ */
+typedef struct CMDBM_PoolStats {
+    uint32_t total;         /* open connections, idle or in use */
+    uint32_t maxcnt;
+    uint32_t waiting;       /* checkouts queued now */
+    uint32_t maxwaiting;    /* deepest queue so far */
+    uint64_t waits;         /* checkouts which had to queue */
+    uint64_t timeouts;
+    uint32_t waitp50;
+    uint32_t waitp90;
+    uint32_t waitp99;
+    uint32_t waitmax;
+    uint32_t idle;
+    uint32_t limit;         /* size limit, moved by adaptive sizing */
+    uint32_t opencost;      /* average milliseconds to open connection */
+    uint32_t utilization;   /* peak percent of limit in use, adaptive */
+    uint64_t grows;         /* limit changes by adaptive sizing */
+    uint64_t shrinks;
+    uint32_t breaker;       /* CMDBM_BreakerState */
+    uint32_t failures;      /* consecutive failures to connect */
+    uint64_t breakeropens;
+    uint64_t rejected;      /* checkouts failed by open breaker */
+} CMDBM_PoolStats;
+
 
 CMBool CMDBM_RegisterDBMS(const char *dbmskey, CMDBM_ModuleInterface *modif);
 
+typedef enum CMDBM_FieldType {
+    CMDBM_FieldInt = 0,     /* int32_t */
+    CMDBM_FieldLong,        /* int64_t */
+    CMDBM_FieldDouble,      /* double */
+    CMDBM_FieldBoolean,     /* CMBool */
+    CMDBM_FieldString,      /* char array, truncated to its size */
+    CMDBM_FieldStringPtr    /* char pointer, allocated with CMAlloc */
+} CMDBM_FieldType;
+
+typedef struct CMDBM_StructField {
+    const char          *name;
+    size_t              offset;
+    size_t              size;
+    CMDBM_FieldType     type;
+    int                 dummy_padder;
+} CMDBM_StructField;
+
+#define CMDBM_STRUCT_FIELD(s, m, t) \
+    { #m, offsetof(s, m), sizeof(((s*)0)->m), t, 0 }
+
+/*
+ * Registers C struct layout which can be used as 'type' of resultMap or
+ * 'resultType' of select query. Field descriptors are copied. Fails if
+ * a field's size differs from the C type of its field type, if a field
+ * lies outside the struct, or if 'name' is registered already.
+ */
+CMDBM_API CMBool CMDBM_RegisterStruct(
+        const char              *name,
+        size_t                  size,
+        const CMDBM_StructField *fields,
+        uint32_t                count);
+
 typedef struct CMDBM_Database CMDBM_Database;
 struct CMDBM_Database {
     CMBool (*AddMapper)(
@@ -128,10 +455,127 @@ CMDBM_Database *CMDBM_DatabaseCreate(
         CMDBM_PoolConfig *poolconf,
         CMUTIL_JsonObject *params);
 
+/*
+ * Fully fetched query result. Column names are kept once per result and
+ * rows are stored as arrays of typed values, addressed by row and column
+ * index. Use GetColumnIndex for name based access.
+ */
+typedef struct CMDBM_ResultSet CMDBM_ResultSet;
+struct CMDBM_ResultSet {
+    uint32_t (*GetColumnCount)(
+            const CMDBM_ResultSet   *rs);
+    const char *(*GetColumnName)(
+            const CMDBM_ResultSet   *rs,
+            uint32_t                col);
+    /* returns -1 if there is no such column. */
+    int (*GetColumnIndex)(
+            const CMDBM_ResultSet   *rs,
+            const char              *name);
+    uint32_t (*GetRowCount)(
+            const CMDBM_ResultSet   *rs);
+    CMJsonValueType (*GetType)(
+            const CMDBM_ResultSet   *rs,
+            uint32_t                row,
+            uint32_t                col);
+    CMBool (*IsNull)(
+            const CMDBM_ResultSet   *rs,
+            uint32_t                row,
+            uint32_t                col);
+    int64_t (*GetLong)(
+            const CMDBM_ResultSet   *rs,
+            uint32_t                row,
+            uint32_t                col);
+    double (*GetDouble)(
+            const CMDBM_ResultSet   *rs,
+            uint32_t                row,
+            uint32_t                col);
+    CMBool (*GetBoolean)(
+            const CMDBM_ResultSet   *rs,
+            uint32_t                row,
+            uint32_t                col);
+    /*
+     * NULL for null or non-string values, length is optional. Strings of
+     * rows spilled to disk are valid until another page of rows is read.
+     */
+    const char *(*GetString)(
+            const CMDBM_ResultSet   *rs,
+            uint32_t                row,
+            uint32_t                col,
+            size_t                  *length);
+    /* builds a new json object for the row, caller must destroy it. */
+    CMUTIL_JsonObject *(*GetRowObject)(
+            const CMDBM_ResultSet   *rs,
+            uint32_t                row);
+    void (*Destroy)(
+            CMDBM_ResultSet         *rs);
+};
+
+/*
+ * Accessor of current cursor row passed to ForEachRowTyped. Values are
+ * read directly from module fetch buffers, string views are valid only
+ * while the callback is running.
+ */
+typedef struct CMDBM_Row CMDBM_Row;
+struct CMDBM_Row {
+    uint32_t (*GetColumnCount)(
+            const CMDBM_Row         *row);
+    const char *(*GetColumnName)(
+            const CMDBM_Row         *row,
+            uint32_t                col);
+    CMJsonValueType (*GetType)(
+            const CMDBM_Row         *row,
+            uint32_t                col);
+    CMBool (*IsNull)(
+            const CMDBM_Row         *row,
+            uint32_t                col);
+    int64_t (*GetLong)(
+            const CMDBM_Row         *row,
+            uint32_t                col);
+    double (*GetDouble)(
+            const CMDBM_Row         *row,
+            uint32_t                col);
+    CMBool (*GetBoolean)(
+            const CMDBM_Row         *row,
+            uint32_t                col);
+    /* NULL for null or non-string values, length is optional. */
+    const char *(*GetStringView)(
+            const CMDBM_Row         *row,
+            uint32_t                col,
+            size_t                  *length);
+    CMDBM_ValueKind (*GetKind)(
+            const CMDBM_Row         *row,
+            uint32_t                col);
+    /* these return CMFalse if value is null or not of the kind. */
+    CMBool (*GetTimestamp)(
+            const CMDBM_Row         *row,
+            uint32_t                col,
+            CMDBM_Timestamp         *ts);
+    CMBool (*GetDecimal)(
+            const CMDBM_Row         *row,
+            uint32_t                col,
+            CMDBM_Decimal           *dec);
+    CMBool (*GetBinary)(
+            const CMDBM_Row         *row,
+            uint32_t                col,
+            CMDBM_Binary            *bin);
+    /*
+     * Streams value of column in chunks instead of reading it at once.
+     * Reader is valid while the callback is running, a column can be read
+     * only once per row and must not be accessed with other getters.
+     */
+    CMDBM_LobReader *(*OpenLobReader)(
+            const CMDBM_Row         *row,
+            uint32_t                col);
+};
+
 typedef struct CMDBM_Session CMDBM_Session;
 struct CMDBM_Session {
     CMBool (*BeginTransaction)(
             CMDBM_Session       *session);
+    /*
+     * Ends transaction started by BeginTransaction. Work not committed
+     * with Commit is rolled back on every database.
+     */
     void (*EndTransaction)(
             CMDBM_Session       *session);
     int (*Execute)(
@@ -170,6 +614,198 @@ struct CMDBM_Session {
             CMDBM_Session       *session);
     void (*Close)(
             CMDBM_Session       *session);
+    /*
+     * Bulk load into 'table'. Rows are taken from 'rows' (array of arrays,
+     * or array of objects keyed by 'columns') when given, otherwise rowcb
+     * is called repeatedly to fill the row writer until it returns CMFalse.
+     * Table and column names are quoted as given, so they match case
+     * sensitively; a dot separates schema from table name.
+     * Returns number of rows loaded or -1 on failure.
+     */
+    int (*CopyIn)(
+            CMDBM_Session       *session,
+            const char          *dbid,
+            const char          *table,
+            CMUTIL_StringArray  *columns,   /* optional */
+            CMUTIL_JsonArray    *rows,      /* optional */
+            void                *udata,
+            CMBool             (*rowcb)(
+                CMDBM_CopyRow       *row,
+                uint32_t            rownum,
+                void                *udata));
+    /*
+     * Bulk export result of query 'sqlid'. Raw data chunks in requested
+     * format are passed to sink, returning CMFalse from sink aborts export.
+     * Returns number of rows exported or -1 on failure.
+     */
+    int (*CopyOut)(
+            CMDBM_Session       *session,
+            const char          *dbid,
+            const char          *sqlid,
+            CMUTIL_JsonObject   *params,
+            CMDBM_CopyFormat    format,
+            void                *udata,
+            CMBool             (*sink)(
+                const char          *data,
+                size_t              size,
+                void                *udata));
+    /*
+     * Same as GetRowSet, but rows are kept in compact result set
+     * which shares column names among rows. When 'resultmemory' database
+     * parameter is set, rows over the budget are spilled to temporary
+     * file and paged back in on access.
+     */
+    CMDBM_ResultSet *(*GetResultSet)(
+            CMDBM_Session       *session,
+            const char          *dbid,
+            const char          *sqlid,
+            CMUTIL_JsonObject   *params);
+    /*
+     * Same as ForEachRow, but callback gets typed accessor of current
+     * row instead of json object, so no per row allocation is made.
+     */
+    CMBool (*ForEachRowTyped)(
+            CMDBM_Session       *session,
+            const char          *dbid,
+            const char          *sqlid,
+            CMUTIL_JsonObject   *params,
+            void                *udata,
+            CMBool             (*rowcb)(
+                const CMDBM_Row     *row,
+                uint32_t            rownum,
+                void                *udata));
+    /*
+     * Fetches at most 'maxrows' rows into caller provided array of structs.
+     * Struct type and column binding are taken from 'resultMap' or
+     * 'resultType' attribute of the query. String pointer fields must be
+     * freed by caller. Returns number of rows stored or -1 on failure.
+     */
+    int (*GetStructList)(
+            CMDBM_Session       *session,
+            const char          *dbid,
+            const char          *sqlid,
+            CMUTIL_JsonObject   *params,
+            void                *rows,
+            uint32_t            maxrows);
+    /*
+     * Same as ForEachRow, but each row is given as struct. String pointer
+     * fields are freed after callback returns unless callback takes them
+     * by setting to NULL.
+     */
+    CMBool (*ForEachStruct)(
+            CMDBM_Session       *session,
+            const char          *dbid,
+            const char          *sqlid,
+            CMUTIL_JsonObject   *params,
+            void                *udata,
+            CMBool             (*rowcb)(
+                void                *item,
+                uint32_t            rownum,
+                void                *udata));
+    /*
+     * When enabled, ForEachRow refills one row object in place instead of
+     * creating new object for each row. Row passed to callback is valid
+     * only until the callback returns, clone it to keep.
+     */
+    void (*SetRowReuse)(
+            CMDBM_Session       *session,
+            CMBool              reuse);
+    /*
+     * Streams result of query 'sqlid' as CSV, TSV or NDJSON text. Output is
+     * buffered and passed to sink in large chunks, returning CMFalse from
+     * sink aborts export. CSV and TSV output starts with a header line.
+     * Returns number of rows exported or -1 on failure.
+     */
+    int (*ExportRows)(
+            CMDBM_Session       *session,
+            const char          *dbid,
+            const char          *sqlid,
+            CMUTIL_JsonObject   *params,
+            CMDBM_ExportFormat  format,
+            void                *udata,
+            CMBool             (*sink)(
+                const char          *data,
+                size_t              size,
+                void                *udata));
+    /*
+     * Fetches result of query 'sqlid' as column-wise record batches of at
+     * most 'batchrows' rows in Arrow C data interface layout. Each batch is
+     * a struct array with one child per column. Schema is owned by the
+     * library. Callback may move the batch out, otherwise it is released
+     * after callback returns. Returns number of rows or -1 on failure.
+     */
+    int (*GetColumnar)(
+            CMDBM_Session       *session,
+            const char          *dbid,
+            const char          *sqlid,
+            CMUTIL_JsonObject   *params,
+            uint32_t            batchrows,
+            void                *udata,
+            CMBool             (*batchcb)(
+                const struct ArrowSchema    *schema,
+                struct ArrowArray           *batch,
+                void                        *udata));
+    /*
+     * When 'batchrows' is not zero, ForEachRow fetches rows in background
+     * thread, filling next batch of 'batchrows' rows while callback
+     * processes current one. Zero disables prefetch. Row reuse is not
+     * applied while prefetch is enabled. The connection belongs to the
+     * prefetch thread during iteration, so the row callback must not run
+     * statements on the same database through this session, nor commit,
+     * roll back or end its transaction. Such calls fail. Use another
+     * session for nested statements.
+     */
+    void (*SetPrefetch)(
+            CMDBM_Session       *session,
+            uint32_t            batchrows);
+    /*
+     * Same as ForEachRow, but rows are dispatched in batches to 'nthreads'
+     * worker threads, so 'rowcb' is called concurrently and must be thread
+     * safe. Optional 'commitcb' is called on calling thread for every row
+     * accepted by 'rowcb', in row order if 'ordered' is CMTrue or in
+     * completion order otherwise. Row may carry results from 'rowcb' to
+     * 'commitcb'. Returning CMFalse from either callback stops iteration,
+     * rows not yet committed are discarded. The session is not thread
+     * safe, so neither callback may run statements through this session,
+     * nor begin, commit, roll back or end its transaction during
+     * iteration. Such calls fail. Use another session per worker for
+     * nested statements.
+     */
+    CMBool (*ForEachRowParallel)(
+            CMDBM_Session       *session,
+            const char          *dbid,
+            const char          *sqlid,
+            CMUTIL_JsonObject   *params,
+            uint32_t            nthreads,
+            CMBool              ordered,
+            void                *udata,
+            CMBool             (*rowcb)(
+                CMUTIL_JsonObject   *row,
+                uint32_t            rownum,
+                void                *udata),
+            CMBool             (*commitcb)(
+                CMUTIL_JsonObject   *row,
+                uint32_t            rownum,
+                void                *udata));
+    /*
+     * Same as Execute, but parameters named in 'lobs' are streamed from
+     * their sources in chunks. Those parameters must be bound with #{name}
+     * in query, their values in 'params' are ignored.
+     */
+    int (*ExecuteLob)(
+            CMDBM_Session       *session,
+            const char          *dbid,
+            const char          *sqlid,
+            CMUTIL_JsonObject   *params,
+            CMDBM_LobSource     *lobs,
+            uint32_t            lobcnt);
+    /*
+     * Milliseconds to wait for pooled connection on later calls of this
+     * session, negative value restores 'checkouttimeout' of databases.
+     */
+    void (*SetCheckoutTimeout)(
+            CMDBM_Session       *session,
+            long                millisec);
 };
 
 typedef struct CMDBM_Context CMDBM_Context;
@@ -181,6 +817,11 @@ struct CMDBM_Context {
             CMDBM_Context       *context);
     void (*Destroy)(
             CMDBM_Context       *context);
+    /* returns CMFalse if there is no database with 'dbid'. */
+    CMBool (*GetPoolStats)(
+            CMDBM_Context       *context,
+            const char          *dbid,
+            CMDBM_PoolStats     *stats);
 };
 
 CMDBM_API CMDBM_Context *CMDBM_ContextCreate(
@@ -563,6 +563,28 @@ CMDBM_STATIC CMBool CMDBM_MapperItemSelectKey(
     return CMTrue;
 }
 
+CMDBM_STATIC CMBool CMDBM_MapperItemResultMap(
+        CMUTIL_Map *queries, CMUTIL_XmlNode *node)
+{
+    if (CMCall(node, GetAttribute, "type") == NULL) {
+        MapperError(node, "'type' attribute required.");
+        return CMFalse;
+    }
+    return CMDBM_MapperItemAddProc(queries, node, CMDBM_NTSqlResultMap);
+}
+
+CMDBM_STATIC CMBool CMDBM_MapperItemResult(
+        CMUTIL_Map *queries, CMUTIL_XmlNode *node)
+{
+    if (CMCall(node, GetAttribute, "column") == NULL ||
+            CMCall(node, GetAttribute, "property") == NULL) {
+        MapperError(node, "'column' and 'property' attributes required.");
+        return CMFalse;
+    }
+    CMDBM_MapperItemProc(queries, node, CMDBM_NTSqlResult);
+    return CMTrue;
+}
+
 static CMUTIL_Map *g_cmdbm_mapper_tagfuncs = NULL;
 
 void CMDBM_MapperInit()
@@ -587,6 +609,9 @@ void CMDBM_MapperInit()
     MAPPER_FUNC("selectKey"    ,CMDBM_MapperItemSelectKey    );
     MAPPER_FUNC("otherwise"    ,CMDBM_MapperItemOtherwise    );
     MAPPER_FUNC("when"        ,CMDBM_MapperItemIf            );
+    MAPPER_FUNC("resultMap"    ,CMDBM_MapperItemResultMap    );
+    MAPPER_FUNC("id"        ,CMDBM_MapperItemResult        );
+    MAPPER_FUNC("result"    ,CMDBM_MapperItemResult        );
 
 }
 
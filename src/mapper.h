@@ -29,6 +29,8 @@ typedef enum {
     ,CMDBM_NTSqlOtherwise
     ,CMDBM_NTSqlIf
     ,CMDBM_NTSqlSelectKey
+    ,CMDBM_NTSqlResultMap
+    ,CMDBM_NTSqlResult
 } CMDBM_NodeType;
 
 typedef enum {
@@ -0,0 +1,256 @@
+
+#include "functions.h"
+
+CMUTIL_LogDefine("cmdbm.parallel")
+
+#define CMDBM_PARALLEL_BATCH    64
+#define CMDBM_PARALLEL_WAIT     100
+
+typedef struct CMDBM_ParallelBatch {
+    CMUTIL_JsonObject   *rows[CMDBM_PARALLEL_BATCH];
+    uint32_t            count;
+    uint32_t            processed;  // leading rows accepted by rowcb
+    uint32_t            base;       // index of first row
+    uint32_t            seq;
+} CMDBM_ParallelBatch;
+
+typedef struct CMDBM_QueueCell {
+    volatile uint32_t   seq;
+    void                *data;
+} CMDBM_QueueCell;
+
+// bounded lock-free multi producer, multi consumer queue.
+typedef struct CMDBM_Queue {
+    CMDBM_QueueCell     *cells;
+    uint32_t            mask;
+    volatile uint32_t   enqpos;
+    volatile uint32_t   deqpos;
+} CMDBM_Queue;
+
+typedef struct CMDBM_Parallel {
+    CMDBM_Queue         work;
+    CMDBM_Queue         done;
+    CMUTIL_Semaphore    *workcnt;
+    CMUTIL_Semaphore    *donecnt;
+    void                *udata;
+    CMBool              (*rowcb)(CMUTIL_JsonObject*, uint32_t, void*);
+    volatile uint32_t   stop;
+} CMDBM_Parallel;
+
+CMDBM_STATIC void CMDBM_QueueInit(CMDBM_Queue *queue, uint32_t mincap)
+{
+    uint32_t i, cap = 2;
+    while (cap < mincap)
+        cap <<= 1;
+    queue->cells = CMAlloc(sizeof(CMDBM_QueueCell) * cap);
+    for (i=0; i<cap; i++) {
+        queue->cells[i].seq = i;
+        queue->cells[i].data = NULL;
+    }
+    queue->mask = cap - 1;
+    queue->enqpos = queue->deqpos = 0;
+}
+
+CMDBM_STATIC CMBool CMDBM_QueuePush(CMDBM_Queue *queue, void *data)
+{
+    CMDBM_QueueCell *cell = NULL;
+    uint32_t pos = CMDBM_AtomicLoad(&queue->enqpos);
+    for (;;) {
+        int32_t diff;
+        cell = &(queue->cells[pos & queue->mask]);
+        diff = (int32_t)(CMDBM_AtomicLoad(&cell->seq) - pos);
+        if (diff == 0) {
+            if (CMDBM_AtomicCAS(&queue->enqpos, pos, pos + 1))
+                break;
+        } else if (diff < 0) {
+            return CMFalse;     // full
+        }
+        pos = CMDBM_AtomicLoad(&queue->enqpos);
+    }
+    cell->data = data;
+    CMDBM_AtomicStore(&cell->seq, pos + 1);
+    return CMTrue;
+}
+
+CMDBM_STATIC CMBool CMDBM_QueuePop(CMDBM_Queue *queue, void **data)
+{
+    CMDBM_QueueCell *cell = NULL;
+    uint32_t pos = CMDBM_AtomicLoad(&queue->deqpos);
+    for (;;) {
+        int32_t diff;
+        cell = &(queue->cells[pos & queue->mask]);
+        diff = (int32_t)(CMDBM_AtomicLoad(&cell->seq) - (pos + 1));
+        if (diff == 0) {
+            if (CMDBM_AtomicCAS(&queue->deqpos, pos, pos + 1))
+                break;
+        } else if (diff < 0) {
+            return CMFalse;     // empty
+        }
+        pos = CMDBM_AtomicLoad(&queue->deqpos);
+    }
+    *data = cell->data;
+    CMDBM_AtomicStore(&cell->seq, pos + queue->mask + 1);
+    return CMTrue;
+}
+
+// waits on counting semaphore, then takes the item it accounts for.
+CMDBM_STATIC void *CMDBM_ParallelTake(
+        CMUTIL_Semaphore *sem, CMDBM_Queue *queue)
+{
+    void *res = NULL;
+    while (!CMCall(sem, Acquire, CMDBM_PARALLEL_WAIT));
+    while (!CMDBM_QueuePop(queue, &res));
+    return res;
+}
+
+CMDBM_STATIC void *CMDBM_ParallelWorker(void *udata)
+{
+    CMDBM_Parallel *par = (CMDBM_Parallel*)udata;
+    CMDBM_ParallelBatch *batch = NULL;
+    // NULL batch is the quit signal.
+    while ((batch = CMDBM_ParallelTake(par->workcnt, &par->work)) != NULL) {
+        uint32_t i;
+        for (i=0; i<batch->count; i++) {
+            if (CMDBM_AtomicLoad(&par->stop))
+                break;
+            if (!par->rowcb(batch->rows[i], batch->base + i, par->udata)) {
+                CMDBM_AtomicStore(&par->stop, 1);
+                break;
+            }
+            batch->processed++;
+        }
+        CMDBM_QueuePush(&par->done, batch);
+        CMCall(par->donecnt, Release);
+    }
+    return NULL;
+}
+
+CMDBM_STATIC CMBool CMDBM_ParallelCommit(
+        CMDBM_Parallel *par, CMDBM_ParallelBatch *batch,
+        CMBool (*commitcb)(CMUTIL_JsonObject*, uint32_t, void*))
+{
+    uint32_t i;
+    for (i=0; i<batch->count; i++) {
+        if (commitcb && i < batch->processed &&
+                !CMDBM_AtomicLoad(&par->stop) &&
+                !commitcb(batch->rows[i], batch->base + i, par->udata))
+            CMDBM_AtomicStore(&par->stop, 1);
+        CMUTIL_JsonDestroy(batch->rows[i]);
+    }
+    batch->count = batch->processed = 0;
+    return CMDBM_AtomicLoad(&par->stop)? CMFalse:CMTrue;
+}
+
+CMBool CMDBM_ParallelForEach(
+        CMDBM_Cursor *cursor, uint32_t nthreads, CMBool ordered, void *udata,
+        CMBool (*rowcb)(CMUTIL_JsonObject*, uint32_t, void*),
+        CMBool (*commitcb)(CMUTIL_JsonObject*, uint32_t, void*))
+{
+    CMBool res = CMFalse, eof = CMFalse;
+    uint32_t i, started = 0, inflight = 0, nbatch, nfree;
+    uint32_t nextseq = 0, commitseq = 0, rowidx = 0;
+    CMUTIL_Thread **threads = NULL;
+    CMDBM_ParallelBatch *batches = NULL;
+    CMDBM_ParallelBatch **freelist = NULL, **pending = NULL;
+    CMDBM_Parallel *par = CMAlloc(sizeof(CMDBM_Parallel));
+    memset(par, 0x0, sizeof(CMDBM_Parallel));
+
+    if (nthreads == 0)
+        nthreads = 1;
+    // two batches per worker, one processed while the next one waits.
+    nbatch = nthreads * 2;
+    par->udata = udata;
+    par->rowcb = rowcb;
+    CMDBM_QueueInit(&par->work, nbatch + nthreads);
+    CMDBM_QueueInit(&par->done, nbatch);
+    par->workcnt = CMUTIL_SemaphoreCreate(0);
+    par->donecnt = CMUTIL_SemaphoreCreate(0);
+    batches = CMAlloc(sizeof(CMDBM_ParallelBatch) * nbatch);
+    memset(batches, 0x0, sizeof(CMDBM_ParallelBatch) * nbatch);
+    freelist = CMAlloc(sizeof(CMDBM_ParallelBatch*) * nbatch);
+    pending = CMAlloc(sizeof(CMDBM_ParallelBatch*) * nbatch);
+    memset(pending, 0x0, sizeof(CMDBM_ParallelBatch*) * nbatch);
+    for (i=0; i<nbatch; i++)
+        freelist[i] = &(batches[i]);
+    nfree = nbatch;
+
+    threads = CMAlloc(sizeof(CMUTIL_Thread*) * nthreads);
+    for (i=0; i<nthreads; i++) {
+        threads[started] = CMUTIL_ThreadCreate(
+                    CMDBM_ParallelWorker, par, "cmdbm-parallel");
+        if (!CMCall(threads[started], Start)) {
+            CMLogError("cannot start parallel worker thread.");
+            CMCall(threads[started], Join);
+            continue;
+        }
+        started++;
+    }
+    if (started == 0)
+        goto ENDPOINT;
+
+    while (!eof || inflight > 0) {
+        CMDBM_ParallelBatch *batch = NULL;
+        void *item = NULL;
+        if (!eof && nfree > 0 && !CMDBM_AtomicLoad(&par->stop)) {
+            CMUTIL_JsonObject *row = NULL;
+            batch = freelist[--nfree];
+            batch->base = rowidx;
+            batch->seq = nextseq++;
+            while (batch->count < CMDBM_PARALLEL_BATCH &&
+                   (row = CMCall(cursor, GetNext)) != NULL)
+                batch->rows[batch->count++] = row;
+            rowidx += batch->count;
+            if (batch->count < CMDBM_PARALLEL_BATCH)
+                eof = CMTrue;
+            CMDBM_QueuePush(&par->work, batch);
+            CMCall(par->workcnt, Release);
+            inflight++;
+            // keep dispatching while free batches remain.
+            if (!CMCall(par->donecnt, Acquire, 0))
+                continue;
+        } else {
+            // nothing more to dispatch, waits for workers.
+            if (CMDBM_AtomicLoad(&par->stop))
+                eof = CMTrue;
+            if (inflight == 0)
+                break;
+            while (!CMCall(par->donecnt, Acquire, CMDBM_PARALLEL_WAIT));
+        }
+        while (!CMDBM_QueuePop(&par->done, &item));
+        batch = (CMDBM_ParallelBatch*)item;
+        inflight--;
+        if (ordered) {
+            // batches in flight never exceed 'nbatch', so slots are unique.
+            pending[batch->seq % nbatch] = batch;
+            while ((batch = pending[commitseq % nbatch]) != NULL &&
+                   batch->seq == commitseq) {
+                pending[commitseq % nbatch] = NULL;
+                CMDBM_ParallelCommit(par, batch, commitcb);
+                freelist[nfree++] = batch;
+                commitseq++;
+            }
+        } else {
+            CMDBM_ParallelCommit(par, batch, commitcb);
+            freelist[nfree++] = batch;
+        }
+    }
+    res = CMTrue;
+
+    for (i=0; i<started; i++) {
+        CMDBM_QueuePush(&par->work, NULL);
+        CMCall(par->workcnt, Release);
+    }
+    for (i=0; i<started; i++)
+        CMCall(threads[i], Join);
+ENDPOINT:
+    CMFree(threads);
+    CMFree(pending);
+    CMFree(freelist);
+    CMFree(batches);
+    CMFree(par->work.cells);
+    CMFree(par->done.cells);
+    CMCall(par->workcnt, Destroy);
+    CMCall(par->donecnt, Destroy);
+    CMFree(par);
+    return res;
+}
@@ -0,0 +1,1341 @@
+
+#include "functions.h"
+
+#if defined(__linux__)
+# include <linux/futex.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+# include <time.h>
+#endif
+
+#if !defined(MSWIN)
+# include <pthread.h>
+#endif
+
+#if defined(_MSC_VER)
+# define CMDBM_THREAD_LOCAL  __declspec(thread)
+#else
+# define CMDBM_THREAD_LOCAL  __thread
+#endif
+
+CMUTIL_LogDefine("cmdbm.pool")
+
+// pools a thread can keep parked resources for at the same time.
+#define CMDBM_POOL_TLS_SIZE     8
+// background maintenance period bounds in milliseconds.
+#define CMDBM_POOL_TICK_MIN     1000
+#define CMDBM_POOL_TICK_MAX     30000
+// threads opening initial resources.
+#define CMDBM_POOL_WARMERS      8
+// milliseconds background opener sleeps before checking for shutdown.
+#define CMDBM_POOL_OPEN_WAIT    1000
+// adaptive sizing samples utilization every tick, resizes every window.
+#define CMDBM_POOL_ADAPT_TICK   1000
+#define CMDBM_POOL_ADAPT_WINDOW 10
+// wait time histogram buckets, bucket n holds waits below 2^n ms.
+#define CMDBM_POOL_HIST_SIZE    32
+
+#define CMDBM_POOL_WAITING      0
+#define CMDBM_POOL_GRANTED      1
+
+// slot states. idle stack holds IDLE, CHECK and DEAD slots, maintenance
+// works on slots in place so checkouts keep finding the others.
+#define CMDBM_SLOT_FREE         0
+#define CMDBM_SLOT_IDLE         1
+#define CMDBM_SLOT_CHECK        2   // resource taken by maintenance
+#define CMDBM_SLOT_LEFT         3   // popped while checked, not in stack
+#define CMDBM_SLOT_DEAD         4   // resource destroyed, still in stack
+
+// index part of stack head, slot index + 1 or zero if empty.
+#define CMDBM_POOL_TOP(h)       ((uint32_t)((h) & 0xFFFFFFFFU))
+// tag part is bumped on every change so a recycled top never matches.
+#define CMDBM_POOL_HEAD(h, top) ((((h) >> 32) + 1) << 32 | (uint64_t)(top))
+
+typedef struct CMDBM_PoolSlot {
+    void                *resource;
+    int64_t             idlesince;  // release time of idle resource
+    int64_t             testedat;   // last release or successful ping
+    volatile uint32_t   next;
+    volatile uint32_t   state;
+} CMDBM_PoolSlot;
+
+// retirement time of a resource, kept only if lifetime is limited.
+typedef struct CMDBM_PoolLife {
+    void                *resource;
+    int64_t             expireat;
+} CMDBM_PoolLife;
+
+// queued checkout, lives on the stack of waiting thread.
+typedef struct CMDBM_PoolWaiter {
+    struct CMDBM_PoolWaiter *next;
+    void                *resource;  // NULL with granted state to create one
+    int64_t             idlesince;
+    volatile uint32_t   state;
+    int                 dummy_padder;
+#if !defined(__linux__)
+    CMUTIL_Semaphore    *sem;
+#endif
+} CMDBM_PoolWaiter;
+
+/*
+ * Resource parked by its owner thread, sweeper may take it back. Owner
+ * thread and pool each hold a reference, the last one frees it. Cache
+ * only the pool refers to is abandoned, a new thread may adopt it.
+ */
+typedef struct CMDBM_PoolCache {
+    void * volatile     parked;
+    volatile int64_t    parkedat;
+    volatile uint32_t   refs;
+    int                 dummy_padder;
+} CMDBM_PoolCache;
+
+typedef struct CMDBM_PoolTls {
+    uint32_t            poolid;
+    int                 dummy_padder;
+    CMDBM_PoolCache     *cache;
+} CMDBM_PoolTls;
+
+static CMDBM_THREAD_LOCAL CMDBM_PoolTls g_cmdbm_pool_tls[CMDBM_POOL_TLS_SIZE];
+static CMDBM_THREAD_LOCAL uint32_t g_cmdbm_pool_tlsnext = 0;
+static CMDBM_THREAD_LOCAL CMBool g_cmdbm_pool_tlsbound = CMFalse;
+static volatile uint32_t g_cmdbm_pool_seq = 0;
+// releases caches of exiting thread.
+#if defined(MSWIN)
+static DWORD g_cmdbm_pool_key = FLS_OUT_OF_INDEXES;
+#else
+static pthread_key_t g_cmdbm_pool_key;
+static CMBool g_cmdbm_pool_haskey = CMFalse;
+#endif
+
+struct CMDBM_Pool {
+    CMDBM_PoolSlot      *slots;
+    volatile uint64_t   idle;       // stack of slots holding idle resource
+    volatile uint64_t   free;       // stack of empty slots
+    volatile uint32_t   total;      // live resources, idle or checked out
+    volatile uint32_t   nwait;      // threads in waiter queue
+    volatile uint32_t   nidle;      // resources in idle stack
+    volatile uint32_t   ndead;      // dead slots left in idle stack
+    uint32_t            nslots;     // twice 'maxcnt', room for dead slots
+    volatile uint32_t   warmleft;   // initial resources not yet opened
+    volatile uint32_t   opening;    // background opener was woken
+    volatile uint32_t   stop;
+    volatile uint32_t   busy;       // maintenance task running
+    uint32_t            maxcnt;
+    volatile uint32_t   limit;      // current size cap, 'maxcnt' if fixed
+    CMBool              testonborrow;
+    uint32_t            testidle;   // borrow test skipped if idle shorter
+    volatile uint32_t   rejected;   // checkouts failed by open breaker
+    void                *(*createf)(void*);
+    void                (*destroyf)(void*, void*);
+    CMBool              (*testf)(void*, void*);
+    void                *udata;
+    CMUTIL_TimerTask    *maintask;
+    int64_t             pingterm;   // milliseconds, zero if not pinging
+    uint32_t            idletimeout;
+    uint32_t            minidle;
+    uint32_t            maxlifetime;
+    uint32_t            nlives;
+    CMUTIL_Mutex        *lifemtx;
+    CMDBM_PoolLife      *lives;
+    CMUTIL_Thread       *opener;
+    CMUTIL_Semaphore    *opensem;
+    char                *name;
+    // adaptive sizing, enabled if 'targetwait' is not zero.
+    uint32_t            mincnt;
+    uint32_t            targetwait;
+    uint32_t            targetpct;
+    volatile uint32_t   opencost;   // moving average of create time in ms
+    volatile uint32_t   checkouts;  // in current window
+    uint32_t            samples;
+    uint32_t            usepeak;    // resources in use, peak of window
+    uint32_t            utilization;
+    uint64_t            grows;
+    uint64_t            shrinks;
+    CMUTIL_TimerTask    *adapttask;
+    // circuit breaker, enabled if 'brkthreshold' is not zero.
+    volatile uint32_t   breaker;    // CMDBM_BreakerState
+    volatile uint32_t   failures;   // consecutive creation failures
+    uint32_t            brkthreshold;
+    uint32_t            brkbackoff;
+    uint32_t            brkmaxbackoff;
+    uint32_t            backoff;    // current open period in ms
+    int64_t             reopenat;
+    uint64_t            brkopens;
+    CMUTIL_Mutex        *brkmtx;
+    uint32_t            poolid;     // never reused, keys thread caches
+    uint32_t            cacheidle;  // zero if thread caching is off
+    CMUTIL_Mutex        *cachemtx;
+    CMUTIL_Array        *caches;
+    CMUTIL_TimerTask    *sweeptask;
+    // waiter queue and statistics below are guarded by 'waitmtx'.
+    CMUTIL_Mutex        *waitmtx;
+    CMDBM_PoolWaiter    *whead;
+    CMDBM_PoolWaiter    *wtail;
+    uint32_t            maxwait;
+    uint32_t            waitmax;
+    uint64_t            waits;
+    uint64_t            timeouts;
+    uint32_t            hist[CMDBM_POOL_HIST_SIZE];
+    uint32_t            winwaits;   // waits of current adaptive window
+    uint32_t            winhist[CMDBM_POOL_HIST_SIZE];
+};
+
+CMDBM_STATIC void CMDBM_PoolPush(
+        CMDBM_Pool *pool, volatile uint64_t *head, uint32_t idx)
+{
+    uint64_t old;
+    do {
+        old = CMDBM_AtomicLoad64(head);
+        CMDBM_AtomicStore(&(pool->slots[idx].next), CMDBM_POOL_TOP(old));
+    } while (!CMDBM_AtomicCAS64(head, old, CMDBM_POOL_HEAD(old, idx + 1)));
+}
+
+CMDBM_STATIC CMBool CMDBM_PoolPop(
+        CMDBM_Pool *pool, volatile uint64_t *head, uint32_t *idx)
+{
+    uint64_t old;
+    uint32_t top, next;
+    do {
+        old = CMDBM_AtomicLoad64(head);
+        top = CMDBM_POOL_TOP(old);
+        if (top == 0)
+            return CMFalse;
+        // slots are never freed, stale 'next' only fails the exchange.
+        next = CMDBM_AtomicLoad(&(pool->slots[top - 1].next));
+    } while (!CMDBM_AtomicCAS64(head, old, CMDBM_POOL_HEAD(old, next)));
+    *idx = top - 1;
+    return CMTrue;
+}
+
+// sets retirement time of new resource, jittered by up to 1/8 lifetime
+// so resources created together do not reconnect at once.
+CMDBM_STATIC void CMDBM_PoolBorn(CMDBM_Pool *pool, void *resource)
+{
+    uint64_t hash;
+    int64_t now = CMDBM_TimeMillis();
+    if (pool->lives == NULL)
+        return;
+    hash = ((uint64_t)(uintptr_t)resource ^ (uint64_t)now) *
+            0x9E3779B97F4A7C15ULL;
+    CMCall(pool->lifemtx, Lock);
+    pool->lives[pool->nlives].resource = resource;
+    pool->lives[pool->nlives].expireat = now + pool->maxlifetime -
+            (int64_t)((hash >> 32) % (pool->maxlifetime / 8 + 1));
+    pool->nlives++;
+    CMCall(pool->lifemtx, Unlock);
+}
+
+CMDBM_STATIC void CMDBM_PoolForget(CMDBM_Pool *pool, void *resource)
+{
+    uint32_t i;
+    if (pool->lives == NULL)
+        return;
+    CMCall(pool->lifemtx, Lock);
+    for (i=0; i<pool->nlives; i++) {
+        if (pool->lives[i].resource == resource) {
+            pool->lives[i] = pool->lives[--pool->nlives];
+            break;
+        }
+    }
+    CMCall(pool->lifemtx, Unlock);
+}
+
+CMDBM_STATIC CMBool CMDBM_PoolExpired(
+        CMDBM_Pool *pool, void *resource, int64_t now)
+{
+    uint32_t i;
+    CMBool res = CMFalse;
+    if (pool->lives == NULL)
+        return CMFalse;
+    CMCall(pool->lifemtx, Lock);
+    for (i=0; i<pool->nlives; i++) {
+        if (pool->lives[i].resource == resource) {
+            res = pool->lives[i].expireat <= now? CMTrue:CMFalse;
+            break;
+        }
+    }
+    CMCall(pool->lifemtx, Unlock);
+    return res;
+}
+
+CMDBM_STATIC void CMDBM_PoolDiscard(CMDBM_Pool *pool, void *resource)
+{
+    CMDBM_PoolForget(pool, resource);
+    pool->destroyf(resource, pool->udata);
+    CMDBM_AtomicAdd(&pool->total, (uint32_t)-1);
+}
+
+/*
+ * Pops idle resource, 'testedat' is its last release or successful ping.
+ * Slots under maintenance are left to it, dead ones are recycled.
+ */
+CMDBM_STATIC CMBool CMDBM_PoolPopIdle(
+        CMDBM_Pool *pool, void **resource, int64_t *testedat)
+{
+    uint32_t idx;
+    while (CMDBM_PoolPop(pool, &pool->idle, &idx)) {
+        CMDBM_PoolSlot *slot = &(pool->slots[idx]);
+        for (;;) {
+            uint32_t state = CMDBM_AtomicLoad(&slot->state);
+            if (state == CMDBM_SLOT_IDLE) {
+                if (!CMDBM_AtomicCAS(&slot->state, state, CMDBM_SLOT_FREE))
+                    continue;
+                *resource = slot->resource;
+                if (testedat)
+                    *testedat = slot->testedat;
+                slot->resource = NULL;
+                CMDBM_PoolPush(pool, &pool->free, idx);
+                CMDBM_AtomicAdd(&pool->nidle, (uint32_t)-1);
+                return CMTrue;
+            } else if (state == CMDBM_SLOT_CHECK) {
+                // maintenance pushes it back when done.
+                if (!CMDBM_AtomicCAS(&slot->state, state, CMDBM_SLOT_LEFT))
+                    continue;
+            } else if (state == CMDBM_SLOT_DEAD) {
+                if (!CMDBM_AtomicCAS(&slot->state, state, CMDBM_SLOT_FREE))
+                    continue;
+                CMDBM_AtomicAdd(&pool->ndead, (uint32_t)-1);
+                CMDBM_PoolPush(pool, &pool->free, idx);
+            }
+            break;
+        }
+    }
+    return CMFalse;
+}
+
+CMDBM_STATIC void CMDBM_PoolPushIdle(
+        CMDBM_Pool *pool, void *resource, int64_t idlesince)
+{
+    uint32_t idx;
+    CMDBM_PoolSlot *slot = NULL;
+    // empty slots always outnumber checked out resources and dead slots.
+    if (!CMDBM_PoolPop(pool, &pool->free, &idx)) {
+        CMLogError("pool has no slot for released resource.");
+        CMDBM_PoolDiscard(pool, resource);
+        return;
+    }
+    slot = &(pool->slots[idx]);
+    slot->resource = resource;
+    slot->idlesince = slot->testedat = idlesince;
+    CMDBM_AtomicStore(&slot->state, CMDBM_SLOT_IDLE);
+    CMDBM_AtomicAdd(&pool->nidle, 1);
+    CMDBM_PoolPush(pool, &pool->idle, idx);
+}
+
+// ends maintenance of slot, pushes it back if a checkout popped it.
+CMDBM_STATIC void CMDBM_PoolUncheck(CMDBM_Pool *pool, uint32_t idx)
+{
+    CMDBM_PoolSlot *slot = &(pool->slots[idx]);
+    if (CMDBM_AtomicCAS(&slot->state, CMDBM_SLOT_CHECK, CMDBM_SLOT_IDLE))
+        return;
+    CMDBM_AtomicStore(&slot->state, CMDBM_SLOT_IDLE);
+    CMDBM_PoolPush(pool, &pool->idle, idx);
+}
+
+// destroys resource of slot under maintenance, slot stays in stack.
+CMDBM_STATIC void CMDBM_PoolKill(CMDBM_Pool *pool, uint32_t idx)
+{
+    CMDBM_PoolSlot *slot = &(pool->slots[idx]);
+    void *resource = slot->resource;
+    slot->resource = NULL;
+    CMDBM_AtomicAdd(&pool->nidle, (uint32_t)-1);
+    CMDBM_AtomicAdd(&pool->ndead, 1);
+    if (!CMDBM_AtomicCAS(&slot->state, CMDBM_SLOT_CHECK, CMDBM_SLOT_DEAD)) {
+        CMDBM_AtomicAdd(&pool->ndead, (uint32_t)-1);
+        CMDBM_AtomicStore(&slot->state, CMDBM_SLOT_FREE);
+        CMDBM_PoolPush(pool, &pool->free, idx);
+    }
+    CMDBM_PoolDiscard(pool, resource);
+}
+
+/*
+ * Parks new resource, into a dead slot if there is one, so dead slots
+ * left below busy ones do not pile up while resources are replaced.
+ */
+CMDBM_STATIC void CMDBM_PoolPushNew(CMDBM_Pool *pool, void *resource)
+{
+    uint32_t i;
+    int64_t now = CMDBM_TimeMillis();
+    for (i=0; i<pool->nslots && CMDBM_AtomicLoad(&pool->ndead) > 0; i++) {
+        CMDBM_PoolSlot *slot = &(pool->slots[i]);
+        if (CMDBM_AtomicLoad(&slot->state) != CMDBM_SLOT_DEAD ||
+                !CMDBM_AtomicCAS(&slot->state,
+                                 CMDBM_SLOT_DEAD, CMDBM_SLOT_CHECK))
+            continue;
+        CMDBM_AtomicAdd(&pool->ndead, (uint32_t)-1);
+        slot->resource = resource;
+        slot->idlesince = slot->testedat = now;
+        CMDBM_AtomicAdd(&pool->nidle, 1);
+        CMDBM_PoolUncheck(pool, i);
+        return;
+    }
+    CMDBM_PoolPushIdle(pool, resource, now);
+}
+
+#if defined(__linux__)
+CMDBM_STATIC void CMDBM_PoolWait(CMDBM_PoolWaiter *waiter, long millisec)
+{
+    struct timespec ts;
+    ts.tv_sec = millisec / 1000;
+    ts.tv_nsec = (millisec % 1000) * 1000000;
+    // returns at once if waiter was granted before sleeping.
+    syscall(SYS_futex, &waiter->state, FUTEX_WAIT_PRIVATE,
+            CMDBM_POOL_WAITING, &ts, NULL, 0);
+}
+
+CMDBM_STATIC void CMDBM_PoolWake(CMDBM_PoolWaiter *waiter)
+{
+    syscall(SYS_futex, &waiter->state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+#else
+CMDBM_STATIC void CMDBM_PoolWait(CMDBM_PoolWaiter *waiter, long millisec)
+{
+    CMCall(waiter->sem, Acquire, millisec);
+}
+
+CMDBM_STATIC void CMDBM_PoolWake(CMDBM_PoolWaiter *waiter)
+{
+    CMCall(waiter->sem, Release);
+}
+#endif
+
+// appends waiter to the queue or puts it back at the head, lock held.
+CMDBM_STATIC void CMDBM_PoolEnqueue(
+        CMDBM_Pool *pool, CMDBM_PoolWaiter *waiter, CMBool front)
+{
+    uint32_t depth;
+    waiter->state = CMDBM_POOL_WAITING;
+    waiter->resource = NULL;
+    waiter->next = NULL;
+    if (pool->whead == NULL) {
+        pool->whead = pool->wtail = waiter;
+    } else if (front) {
+        waiter->next = pool->whead;
+        pool->whead = waiter;
+    } else {
+        pool->wtail->next = waiter;
+        pool->wtail = waiter;
+    }
+    depth = CMDBM_AtomicAdd(&pool->nwait, 1) + 1;
+    if (depth > pool->maxwait)
+        pool->maxwait = depth;
+    // pairs with the fence in CMDBM_PoolNotify.
+    CMDBM_AtomicFence();
+}
+
+// removes timed out waiter from the queue, lock held.
+CMDBM_STATIC void CMDBM_PoolUnlink(
+        CMDBM_Pool *pool, CMDBM_PoolWaiter *waiter)
+{
+    CMDBM_PoolWaiter *prev = NULL, *curr = pool->whead;
+    while (curr && curr != waiter) {
+        prev = curr;
+        curr = curr->next;
+    }
+    if (curr == NULL)
+        return;
+    if (prev)
+        prev->next = waiter->next;
+    else
+        pool->whead = waiter->next;
+    if (pool->wtail == waiter)
+        pool->wtail = prev;
+    CMDBM_AtomicAdd(&pool->nwait, (uint32_t)-1);
+}
+
+/*
+ * Hands idle resources to queued waiters in arrival order, lock held.
+ * When no resource is idle but pool is below maximum, head waiter is
+ * granted without resource to create one by itself, if 'grow' is set.
+ */
+CMDBM_STATIC void CMDBM_PoolDispatch(CMDBM_Pool *pool, CMBool grow)
+{
+    while (pool->whead) {
+        void *resource = NULL;
+        int64_t idlesince = 0;
+        CMDBM_PoolWaiter *waiter = pool->whead;
+        if (!CMDBM_PoolPopIdle(pool, &resource, &idlesince)) {
+            if (!grow || CMDBM_AtomicLoad(&pool->total) >=
+                    CMDBM_AtomicLoad(&pool->limit))
+                break;
+            grow = CMFalse;
+        }
+        pool->whead = waiter->next;
+        if (pool->whead == NULL)
+            pool->wtail = NULL;
+        CMDBM_AtomicAdd(&pool->nwait, (uint32_t)-1);
+        waiter->resource = resource;
+        waiter->idlesince = idlesince;
+        CMDBM_AtomicStore(&waiter->state, CMDBM_POOL_GRANTED);
+        // waiter takes the lock before leaving, so it is still alive here.
+        CMDBM_PoolWake(waiter);
+    }
+}
+
+// serves queued waiters after resource is released or destroyed.
+CMDBM_STATIC void CMDBM_PoolNotify(CMDBM_Pool *pool)
+{
+    CMDBM_AtomicFence();
+    if (CMDBM_AtomicLoad(&pool->nwait) > 0) {
+        CMCall(pool->waitmtx, Lock);
+        CMDBM_PoolDispatch(pool, CMTrue);
+        CMCall(pool->waitmtx, Unlock);
+    }
+}
+
+CMDBM_STATIC void CMDBM_PoolRecordWait(
+        CMDBM_Pool *pool, int64_t waited, CMBool timedout)
+{
+    uint32_t bucket = 0, ms = waited < 0? 0:(uint32_t)waited;
+    while (bucket < CMDBM_POOL_HIST_SIZE - 1 && (ms >> bucket) > 0)
+        bucket++;
+    pool->hist[bucket]++;
+    pool->waits++;
+    pool->winhist[bucket]++;
+    pool->winwaits++;
+    if (timedout)
+        pool->timeouts++;
+    if (ms > pool->waitmax)
+        pool->waitmax = ms;
+}
+
+/*
+ * Upper bound of the bucket holding 'pct' percent of 'count' waits,
+ * waits missing from 'hist' are taken as zero. Lock held.
+ */
+CMDBM_STATIC uint32_t CMDBM_PoolPercentile(
+        CMDBM_Pool *pool, const uint32_t *hist, uint64_t count, uint32_t pct)
+{
+    uint32_t i;
+    uint64_t sum = count, rank = (count * pct + 99) / 100;
+    if (count == 0)
+        return 0;
+    for (i=0; i<CMDBM_POOL_HIST_SIZE; i++)
+        sum -= hist[i];
+    for (i=0; i<CMDBM_POOL_HIST_SIZE; i++) {
+        sum += hist[i];
+        if (sum >= rank)
+            break;
+    }
+    if (i == 0)
+        return 0;
+    if (i >= 31 || ((1U << i) - 1) > pool->waitmax)
+        return pool->waitmax;
+    return (1U << i) - 1;
+}
+
+// fails queued checkouts at once, they would wait in vain. lock held.
+CMDBM_STATIC void CMDBM_PoolFailWaiters(CMDBM_Pool *pool)
+{
+    while (pool->whead) {
+        CMDBM_PoolWaiter *waiter = pool->whead;
+        pool->whead = waiter->next;
+        if (pool->whead == NULL)
+            pool->wtail = NULL;
+        CMDBM_AtomicAdd(&pool->nwait, (uint32_t)-1);
+        waiter->resource = NULL;
+        CMDBM_AtomicStore(&waiter->state, CMDBM_POOL_GRANTED);
+        CMDBM_PoolWake(waiter);
+    }
+}
+
+// counts creation result, opens or closes circuit breaker.
+CMDBM_STATIC void CMDBM_PoolBreakerResult(CMDBM_Pool *pool, CMBool success)
+{
+    CMBool opened = CMFalse;
+    if (pool->brkthreshold == 0)
+        return;
+    if (success && CMDBM_AtomicLoad(&pool->failures) == 0 &&
+            CMDBM_AtomicLoad(&pool->breaker) == CMDBM_BreakerClosed)
+        return;
+    CMCall(pool->brkmtx, Lock);
+    if (success) {
+        CMDBM_AtomicStore(&pool->failures, 0);
+        if (CMDBM_AtomicLoad(&pool->breaker) != CMDBM_BreakerClosed) {
+            CMDBM_AtomicStore(&pool->breaker, CMDBM_BreakerClosed);
+            pool->backoff = pool->brkbackoff;
+            CMLogInfo("pool '%s' circuit breaker closed.", pool->name);
+        }
+    } else {
+        uint32_t failures = CMDBM_AtomicAdd(&pool->failures, 1) + 1;
+        uint32_t state = CMDBM_AtomicLoad(&pool->breaker);
+        if (state == CMDBM_BreakerHalfOpen) {
+            // probe failed, waits longer before the next one.
+            pool->backoff *= 2;
+            if (pool->backoff > pool->brkmaxbackoff)
+                pool->backoff = pool->brkmaxbackoff;
+            opened = CMTrue;
+        } else if (state == CMDBM_BreakerClosed &&
+                   failures >= pool->brkthreshold) {
+            pool->backoff = pool->brkbackoff;
+            opened = CMTrue;
+        }
+        if (opened) {
+            pool->reopenat = CMDBM_TimeMillis() + pool->backoff;
+            pool->brkopens++;
+            CMDBM_AtomicStore(&pool->breaker, CMDBM_BreakerOpen);
+            CMLogError("pool '%s' circuit breaker opened after %u failures, "
+                       "next probe in %u ms.",
+                       pool->name, failures, pool->backoff);
+        }
+    }
+    CMCall(pool->brkmtx, Unlock);
+    if (opened) {
+        CMCall(pool->waitmtx, Lock);
+        CMDBM_PoolFailWaiters(pool);
+        CMCall(pool->waitmtx, Unlock);
+    }
+}
+
+CMDBM_STATIC CMBool CMDBM_PoolCreateOne(CMDBM_Pool *pool, void **resource)
+{
+    uint32_t cnt, cost;
+    int64_t begin;
+    do {
+        cnt = CMDBM_AtomicLoad(&pool->total);
+        if (cnt >= CMDBM_AtomicLoad(&pool->limit))
+            return CMFalse;
+    } while (!CMDBM_AtomicCAS(&pool->total, cnt, cnt + 1));
+    begin = CMDBM_TimeMillis();
+    *resource = pool->createf(pool->udata);
+    if (*resource == NULL) {
+        CMDBM_AtomicAdd(&pool->total, (uint32_t)-1);
+        CMDBM_PoolBreakerResult(pool, CMFalse);
+        return CMFalse;
+    }
+    // concurrent creations may lose a sample, average stays close.
+    cost = (uint32_t)(CMDBM_TimeMillis() - begin);
+    cnt = CMDBM_AtomicLoad(&pool->opencost);
+    CMDBM_AtomicStore(&pool->opencost, cnt == 0? cost:(cnt * 7 + cost) / 8);
+    CMDBM_PoolBorn(pool, *resource);
+    CMDBM_PoolBreakerResult(pool, CMTrue);
+    return CMTrue;
+}
+
+// creates new resource below limit unless circuit breaker is open.
+CMDBM_STATIC CMBool CMDBM_PoolGrow(CMDBM_Pool *pool, void **resource)
+{
+    if (CMDBM_AtomicLoad(&pool->breaker) != CMDBM_BreakerClosed)
+        return CMFalse;
+    return CMDBM_PoolCreateOne(pool, resource);
+}
+
+/*
+ * Returns CMFalse if checkout must fail at once. When open period is
+ * over, the caller becomes the only probe and reconnects once, others
+ * keep failing until the probe closes the breaker.
+ */
+CMDBM_STATIC CMBool CMDBM_PoolBreakerPass(CMDBM_Pool *pool)
+{
+    void *resource = NULL;
+    CMBool probe = CMFalse;
+    if (CMDBM_AtomicLoad(&pool->breaker) == CMDBM_BreakerClosed)
+        return CMTrue;
+    CMCall(pool->brkmtx, Lock);
+    if (CMDBM_AtomicLoad(&pool->breaker) == CMDBM_BreakerOpen &&
+            CMDBM_TimeMillis() >= pool->reopenat) {
+        CMDBM_AtomicStore(&pool->breaker, CMDBM_BreakerHalfOpen);
+        CMLogInfo("pool '%s' circuit breaker half-open, probing.",
+                  pool->name);
+        probe = CMTrue;
+    }
+    CMCall(pool->brkmtx, Unlock);
+    if (!probe)
+        return CMDBM_AtomicLoad(&pool->breaker) == CMDBM_BreakerClosed?
+                    CMTrue:CMFalse;
+    if (!CMDBM_PoolCreateOne(pool, &resource)) {
+        // pool is full, nothing to probe, resumes normal checkout.
+        if (CMDBM_AtomicLoad(&pool->breaker) == CMDBM_BreakerHalfOpen)
+            CMDBM_PoolBreakerResult(pool, CMTrue);
+        return CMDBM_AtomicLoad(&pool->breaker) == CMDBM_BreakerClosed?
+                    CMTrue:CMFalse;
+    }
+    CMDBM_PoolPushNew(pool, resource);
+    CMDBM_PoolNotify(pool);
+    return CMTrue;
+}
+
+// borrow test is skipped for resources released moments ago.
+CMDBM_STATIC CMBool CMDBM_PoolValidate(
+        CMDBM_Pool *pool, void *resource, int64_t idlesince)
+{
+    if (!pool->testonborrow ||
+            CMDBM_TimeMillis() - idlesince < (int64_t)pool->testidle ||
+            pool->testf(resource, pool->udata))
+        return CMTrue;
+    CMLogInfo("pooled resource failed test, discarding.");
+    CMDBM_PoolDiscard(pool, resource);
+    return CMFalse;
+}
+
+CMDBM_STATIC CMBool CMDBM_PoolTake(CMDBM_Pool *pool, void **resource)
+{
+    int64_t idlesince = 0;
+    while (CMDBM_PoolPopIdle(pool, resource, &idlesince)) {
+        if (CMDBM_PoolValidate(pool, *resource, idlesince))
+            return CMTrue;
+    }
+    return CMDBM_PoolGrow(pool, resource);
+}
+
+// opens resources until 'cnt' more are idle or pool is full.
+CMDBM_STATIC uint32_t CMDBM_PoolFill(CMDBM_Pool *pool, uint32_t cnt)
+{
+    uint32_t res = 0;
+    while (res < cnt) {
+        void *resource = NULL;
+        if (!CMDBM_PoolGrow(pool, &resource))
+            break;
+        CMDBM_PoolPushNew(pool, resource);
+        CMDBM_PoolNotify(pool);
+        res++;
+    }
+    return res;
+}
+
+// wakes background opener if idle resources dropped below 'minidle'.
+CMDBM_STATIC void CMDBM_PoolWakeOpener(CMDBM_Pool *pool)
+{
+    if (pool->opener &&
+            CMDBM_AtomicLoad(&pool->nidle) < pool->minidle &&
+            CMDBM_AtomicLoad(&pool->total) <
+                CMDBM_AtomicLoad(&pool->limit) &&
+            CMDBM_AtomicCAS(&pool->opening, 0, 1))
+        CMCall(pool->opensem, Release);
+}
+
+CMDBM_STATIC void *CMDBM_PoolOpenProc(void *data)
+{
+    CMDBM_Pool *pool = (CMDBM_Pool*)data;
+    while (!CMDBM_AtomicLoad(&pool->stop)) {
+        if (!CMCall(pool->opensem, Acquire, CMDBM_POOL_OPEN_WAIT))
+            continue;
+        // stops at first failure, next checkout wakes it again.
+        while (!CMDBM_AtomicLoad(&pool->stop) &&
+               CMDBM_AtomicLoad(&pool->nidle) < pool->minidle &&
+               CMDBM_PoolFill(pool, 1) > 0);
+        CMDBM_AtomicStore(&pool->opening, 0);
+    }
+    return NULL;
+}
+
+CMDBM_STATIC void *CMDBM_PoolWarmProc(void *data)
+{
+    CMDBM_Pool *pool = (CMDBM_Pool*)data;
+    for (;;) {
+        uint32_t left = CMDBM_AtomicLoad(&pool->warmleft);
+        if (left == 0)
+            break;
+        if (!CMDBM_AtomicCAS(&pool->warmleft, left, left - 1))
+            continue;
+        // others stop too when database refuses connection.
+        if (CMDBM_PoolFill(pool, 1) == 0) {
+            CMDBM_AtomicStore(&pool->warmleft, 0);
+            break;
+        }
+    }
+    return NULL;
+}
+
+// opens 'cnt' resources in parallel, calling thread takes part.
+CMDBM_STATIC void CMDBM_PoolWarmUp(CMDBM_Pool *pool, uint32_t cnt)
+{
+    uint32_t i, started = 0;
+    uint32_t nthreads = cnt < CMDBM_POOL_WARMERS? cnt:CMDBM_POOL_WARMERS;
+    CMUTIL_Thread *threads[CMDBM_POOL_WARMERS];
+    pool->warmleft = cnt;
+    for (i=1; i<nthreads; i++) {
+        threads[started] = CMUTIL_ThreadCreate(
+                    CMDBM_PoolWarmProc, pool, "cmdbm-pool-warmup");
+        if (!CMCall(threads[started], Start)) {
+            CMLogError("cannot start pool warm up thread.");
+            CMCall(threads[started], Join);
+            continue;
+        }
+        started++;
+    }
+    CMDBM_PoolWarmProc(pool);
+    for (i=0; i<started; i++)
+        CMCall(threads[i], Join);
+}
+
+CMDBM_STATIC void CMDBM_PoolCacheUnref(CMDBM_PoolCache *cache)
+{
+    if (CMDBM_AtomicAdd(&cache->refs, (uint32_t)-1) == 1)
+        CMFree(cache);
+}
+
+// drops this thread's references, on eviction or thread exit.
+CMDBM_STATIC void CMDBM_PoolTlsRelease(CMDBM_PoolTls *tls)
+{
+    if (tls->cache) {
+        CMDBM_PoolCacheUnref(tls->cache);
+        tls->cache = NULL;
+    }
+    tls->poolid = 0;
+}
+
+#if defined(MSWIN)
+CMDBM_STATIC VOID WINAPI CMDBM_PoolThreadExit(PVOID data)
+#else
+CMDBM_STATIC void CMDBM_PoolThreadExit(void *data)
+#endif
+{
+    uint32_t i;
+    CMDBM_PoolTls *tls = (CMDBM_PoolTls*)data;
+    for (i=0; i<CMDBM_POOL_TLS_SIZE; i++)
+        CMDBM_PoolTlsRelease(&(tls[i]));
+}
+
+void CMDBM_PoolInit(void)
+{
+#if defined(MSWIN)
+    g_cmdbm_pool_key = FlsAlloc(CMDBM_PoolThreadExit);
+#else
+    g_cmdbm_pool_haskey = pthread_key_create(
+                &g_cmdbm_pool_key, CMDBM_PoolThreadExit) == 0?
+                CMTrue:CMFalse;
+#endif
+}
+
+void CMDBM_PoolClear(void)
+{
+#if defined(MSWIN)
+    if (g_cmdbm_pool_key != FLS_OUT_OF_INDEXES)
+        FlsFree(g_cmdbm_pool_key);
+    g_cmdbm_pool_key = FLS_OUT_OF_INDEXES;
+#else
+    if (g_cmdbm_pool_haskey)
+        pthread_key_delete(g_cmdbm_pool_key);
+    g_cmdbm_pool_haskey = CMFalse;
+#endif
+}
+
+CMDBM_STATIC CMDBM_PoolCache *CMDBM_PoolGetCache(
+        CMDBM_Pool *pool, CMBool create)
+{
+    uint32_t i, size;
+    CMDBM_PoolTls *tls = NULL;
+    CMDBM_PoolCache *cache = NULL;
+    for (i=0; i<CMDBM_POOL_TLS_SIZE; i++)
+        if (g_cmdbm_pool_tls[i].poolid == pool->poolid)
+            return g_cmdbm_pool_tls[i].cache;
+    if (!create)
+        return NULL;
+    if (!g_cmdbm_pool_tlsbound) {
+#if defined(MSWIN)
+        if (g_cmdbm_pool_key != FLS_OUT_OF_INDEXES)
+            FlsSetValue(g_cmdbm_pool_key, g_cmdbm_pool_tls);
+#else
+        if (g_cmdbm_pool_haskey)
+            pthread_setspecific(g_cmdbm_pool_key, g_cmdbm_pool_tls);
+#endif
+        g_cmdbm_pool_tlsbound = CMTrue;
+    }
+    // evicted cache is abandoned, sweeper drains and frees it.
+    tls = &(g_cmdbm_pool_tls[g_cmdbm_pool_tlsnext++ % CMDBM_POOL_TLS_SIZE]);
+    CMDBM_PoolTlsRelease(tls);
+    CMCall(pool->cachemtx, Lock);
+    size = (uint32_t)CMCall(pool->caches, GetSize);
+    for (i=0; i<size && cache == NULL; i++) {
+        cache = (CMDBM_PoolCache*)CMCall(pool->caches, GetAt, i);
+        if (!CMDBM_AtomicCAS(&cache->refs, 1, 2))
+            cache = NULL;
+    }
+    if (cache == NULL) {
+        cache = CMAlloc(sizeof(CMDBM_PoolCache));
+        memset(cache, 0x0, sizeof(CMDBM_PoolCache));
+        cache->refs = 2;
+        CMCall(pool->caches, Add, cache, NULL);
+    }
+    CMCall(pool->cachemtx, Unlock);
+    tls->cache = cache;
+    tls->poolid = pool->poolid;
+    return cache;
+}
+
+/*
+ * Returns resources parked at least 'minage' milliseconds to the pool.
+ * Abandoned caches are drained and freed if 'prune' is set.
+ */
+CMDBM_STATIC uint32_t CMDBM_PoolReclaim(
+        CMDBM_Pool *pool, int64_t minage, CMBool prune)
+{
+    uint32_t i, res = 0;
+    int64_t now = CMDBM_TimeMillis();
+    CMCall(pool->cachemtx, Lock);
+    i = (uint32_t)CMCall(pool->caches, GetSize);
+    while (i > 0) {
+        CMDBM_PoolCache *cache =
+                (CMDBM_PoolCache*)CMCall(pool->caches, GetAt, --i);
+        // adoption takes this lock, so abandoned cache stays abandoned.
+        CMBool abandoned = prune && CMDBM_AtomicLoad(&cache->refs) == 1?
+                    CMTrue:CMFalse;
+        if (cache->parked && (abandoned || now - cache->parkedat >= minage)) {
+            void *resource = CMDBM_AtomicSwapPtr(&cache->parked, NULL);
+            if (resource) {
+                CMDBM_PoolPushIdle(pool, resource, cache->parkedat);
+                CMDBM_PoolNotify(pool);
+                res++;
+            }
+        }
+        if (abandoned) {
+            CMCall(pool->caches, RemoveAt, i);
+            CMDBM_PoolCacheUnref(cache);
+        }
+    }
+    CMCall(pool->cachemtx, Unlock);
+    return res;
+}
+
+CMDBM_STATIC void CMDBM_PoolSweepProc(void *data)
+{
+    CMDBM_Pool *pool = (CMDBM_Pool*)data;
+    CMDBM_PoolReclaim(pool, (int64_t)pool->cacheidle, CMTrue);
+}
+
+// lets each thread park one released resource for its next checkout.
+CMDBM_STATIC void CMDBM_PoolSetThreadCache(
+        CMDBM_Pool *pool, uint32_t idlems, CMUTIL_Timer *timer)
+{
+    long period = (long)idlems;
+    if (timer == NULL) {
+        CMLogError("thread cache needs a timer to return idle resources.");
+        return;
+    }
+    pool->cachemtx = CMUTIL_MutexCreate();
+    pool->caches = CMUTIL_ArrayCreateEx(16, NULL, NULL);
+    pool->cacheidle = idlems;
+    if (period < 100)
+        period = 100;
+    pool->sweeptask = CMCall(timer, ScheduleDelayRepeat, period, period,
+                             CMTrue, CMDBM_PoolSweepProc, pool);
+}
+
+void *CMDBM_PoolCheckOut(CMDBM_Pool *pool, long millisec)
+{
+    void *res = NULL;
+    CMBool grow = CMTrue;
+    int64_t begin, deadline;
+    CMDBM_PoolWaiter waiter;
+    // database is unreachable, fails without waiting for a timeout.
+    if (pool->brkthreshold > 0 && !CMDBM_PoolBreakerPass(pool)) {
+        CMDBM_AtomicAdd(&pool->rejected, 1);
+        CMLogDebug("pool '%s' circuit breaker is open, checkout rejected.",
+                   pool->name);
+        return NULL;
+    }
+    if (pool->targetwait > 0)
+        CMDBM_AtomicAdd(&pool->checkouts, 1);
+    if (pool->cacheidle > 0) {
+        // owner thread takes its parked resource without shared access.
+        CMDBM_PoolCache *cache = CMDBM_PoolGetCache(pool, CMFalse);
+        if (cache && cache->parked &&
+                (res = CMDBM_AtomicSwapPtr(&cache->parked, NULL)) != NULL &&
+                CMDBM_PoolValidate(pool, res, cache->parkedat))
+            return res;
+        res = NULL;
+    }
+    // newcomers do not pass threads already queued.
+    if (CMDBM_AtomicLoad(&pool->nwait) == 0 && CMDBM_PoolTake(pool, &res)) {
+        CMDBM_PoolWakeOpener(pool);
+        return res;
+    }
+    // resources parked by other threads are served to the queue.
+    if (pool->cacheidle > 0)
+        CMDBM_PoolReclaim(pool, 0, CMFalse);
+    CMDBM_PoolWakeOpener(pool);
+
+    begin = CMDBM_TimeMillis();
+    deadline = begin + millisec;
+    memset(&waiter, 0x0, sizeof(CMDBM_PoolWaiter));
+#if !defined(__linux__)
+    waiter.sem = CMUTIL_SemaphoreCreate(0);
+#endif
+    CMCall(pool->waitmtx, Lock);
+    CMDBM_PoolEnqueue(pool, &waiter, CMFalse);
+    for (;;) {
+        // releases before enqueue are served here.
+        CMDBM_PoolDispatch(pool, grow);
+        while (CMDBM_AtomicLoad(&waiter.state) == CMDBM_POOL_WAITING) {
+            long remain = (long)(deadline - CMDBM_TimeMillis());
+            if (remain <= 0)
+                break;
+            CMCall(pool->waitmtx, Unlock);
+            CMDBM_PoolWait(&waiter, remain);
+            CMCall(pool->waitmtx, Lock);
+        }
+        if (waiter.state == CMDBM_POOL_WAITING) {
+            CMDBM_PoolUnlink(pool, &waiter);
+            break;
+        }
+        CMCall(pool->waitmtx, Unlock);
+
+        // granted, resource is tested or created outside of the lock.
+        res = waiter.resource;
+        if (res && !CMDBM_PoolValidate(pool, res, waiter.idlesince))
+            res = NULL;
+        else if (res == NULL)
+            CMDBM_PoolGrow(pool, &res);
+        CMCall(pool->waitmtx, Lock);
+        if (res)
+            break;
+        // keeps its turn, but does not retry failed creation by itself.
+        grow = waiter.resource? CMTrue:CMFalse;
+        if ((long)(deadline - CMDBM_TimeMillis()) <= 0 ||
+                CMDBM_AtomicLoad(&pool->breaker) != CMDBM_BreakerClosed)
+            break;
+        CMDBM_PoolEnqueue(pool, &waiter, CMTrue);
+    }
+    CMDBM_PoolRecordWait(pool, CMDBM_TimeMillis() - begin,
+                         res? CMFalse:CMTrue);
+    CMCall(pool->waitmtx, Unlock);
+#if !defined(__linux__)
+    CMCall(waiter.sem, Destroy);
+#endif
+    return res;
+}
+
+void CMDBM_PoolGetStats(CMDBM_Pool *pool, CMDBM_PoolStats *stats)
+{
+    memset(stats, 0x0, sizeof(CMDBM_PoolStats));
+    stats->total = CMDBM_AtomicLoad(&pool->total);
+    stats->maxcnt = pool->maxcnt;
+    CMCall(pool->waitmtx, Lock);
+    stats->waiting = CMDBM_AtomicLoad(&pool->nwait);
+    stats->maxwaiting = pool->maxwait;
+    stats->waits = pool->waits;
+    stats->timeouts = pool->timeouts;
+    stats->waitp50 = CMDBM_PoolPercentile(pool, pool->hist, pool->waits, 50);
+    stats->waitp90 = CMDBM_PoolPercentile(pool, pool->hist, pool->waits, 90);
+    stats->waitp99 = CMDBM_PoolPercentile(pool, pool->hist, pool->waits, 99);
+    stats->waitmax = pool->waitmax;
+    CMCall(pool->waitmtx, Unlock);
+    stats->idle = CMDBM_AtomicLoad(&pool->nidle);
+    stats->limit = CMDBM_AtomicLoad(&pool->limit);
+    stats->opencost = CMDBM_AtomicLoad(&pool->opencost);
+    stats->utilization = pool->utilization;
+    stats->grows = pool->grows;
+    stats->shrinks = pool->shrinks;
+    if (pool->brkmtx) {
+        CMCall(pool->brkmtx, Lock);
+        stats->breaker = CMDBM_AtomicLoad(&pool->breaker);
+        stats->failures = CMDBM_AtomicLoad(&pool->failures);
+        stats->breakeropens = pool->brkopens;
+        CMCall(pool->brkmtx, Unlock);
+    }
+    stats->rejected = CMDBM_AtomicLoad(&pool->rejected);
+}
+
+void CMDBM_PoolRelease(CMDBM_Pool *pool, void *resource)
+{
+    // parks resource unless other threads are waiting for one.
+    if (pool->cacheidle > 0 && CMDBM_AtomicLoad(&pool->nwait) == 0) {
+        CMDBM_PoolCache *cache = CMDBM_PoolGetCache(pool, CMTrue);
+        // only this thread fills the cache, sweeper only empties it.
+        if (cache->parked == NULL) {
+            cache->parkedat = CMDBM_TimeMillis();
+            (void)CMDBM_AtomicSwapPtr(&cache->parked, resource);
+            return;
+        }
+    }
+    CMDBM_PoolPushIdle(pool, resource, CMDBM_TimeMillis());
+    CMDBM_PoolNotify(pool);
+}
+
+#define CMDBM_POOL_KEEP         0
+#define CMDBM_POOL_RETIRE       1
+#define CMDBM_POOL_EVICT        2
+#define CMDBM_POOL_PING         3
+
+// what maintenance has to do with idle resource of slot.
+CMDBM_STATIC int CMDBM_PoolDue(
+        CMDBM_Pool *pool, CMDBM_PoolSlot *slot, int64_t now)
+{
+    // dead slots must not outnumber spare ones, waits for recycling.
+    if (CMDBM_AtomicLoad(&pool->ndead) >= pool->nslots - pool->maxcnt)
+        return CMDBM_POOL_KEEP;
+    if (CMDBM_PoolExpired(pool, slot->resource, now))
+        return CMDBM_POOL_RETIRE;
+    if (pool->idletimeout > 0 &&
+            CMDBM_AtomicLoad(&pool->nidle) > pool->minidle &&
+            now - slot->idlesince >= (int64_t)pool->idletimeout)
+        return CMDBM_POOL_EVICT;
+    if (pool->pingterm > 0 && now - slot->testedat >= pool->pingterm)
+        return CMDBM_POOL_PING;
+    return CMDBM_POOL_KEEP;
+}
+
+/*
+ * Runs on timer: retires idle resources past their lifetime or idle
+ * longer than 'idletimeout' beyond 'minidle', pings the ones not used
+ * for 'pingterm', then lets opener bring idle ones up to 'minidle'.
+ * Each due slot is taken in place and given back at once, others stay
+ * available to checkouts and keep their order in idle stack.
+ * Probes database while circuit breaker is open and nobody checks out.
+ */
+CMDBM_STATIC void CMDBM_PoolMaintainProc(void *data)
+{
+    CMDBM_Pool *pool = (CMDBM_Pool*)data;
+    uint32_t i;
+    // timer may run next round before this one ends.
+    if (!CMDBM_AtomicCAS(&pool->busy, 0, 1))
+        return;
+    if (pool->brkthreshold > 0)
+        CMDBM_PoolBreakerPass(pool);
+    for (i=0; i<pool->nslots; i++) {
+        CMDBM_PoolSlot *slot = &(pool->slots[i]);
+        int64_t now = CMDBM_TimeMillis();
+        // unlocked look first, decided again once the slot is taken.
+        if (CMDBM_AtomicLoad(&slot->state) != CMDBM_SLOT_IDLE ||
+                CMDBM_PoolDue(pool, slot, now) == CMDBM_POOL_KEEP ||
+                !CMDBM_AtomicCAS(&slot->state,
+                                 CMDBM_SLOT_IDLE, CMDBM_SLOT_CHECK))
+            continue;
+        switch (CMDBM_PoolDue(pool, slot, now)) {
+        case CMDBM_POOL_RETIRE:
+            CMLogDebug("pooled resource reached its lifetime, retiring.");
+            CMDBM_PoolKill(pool, i);
+            break;
+        case CMDBM_POOL_EVICT:
+            CMLogDebug("pooled resource idle too long, evicting.");
+            CMDBM_PoolKill(pool, i);
+            break;
+        case CMDBM_POOL_PING:
+            if (pool->testf(slot->resource, pool->udata)) {
+                slot->testedat = CMDBM_TimeMillis();
+                CMDBM_PoolUncheck(pool, i);
+            } else {
+                CMLogInfo("idle pooled resource failed test, discarding.");
+                CMDBM_PoolKill(pool, i);
+            }
+            break;
+        default:
+            CMDBM_PoolUncheck(pool, i);
+        }
+        CMDBM_PoolNotify(pool);
+    }
+    CMDBM_PoolWakeOpener(pool);
+    CMDBM_AtomicStore(&pool->busy, 0);
+}
+
+/*
+ * Runs on timer: samples resources in use every tick and moves size limit
+ * between 'mincnt' and 'maxcnt' at the end of each window. Limit grows by
+ * a quarter while 'targetpct' percentile of checkout wait is over
+ * 'targetwait', and shrinks by one when the window had no wait and used
+ * less than half of it, or a quarter if creating is slower than target.
+ */
+CMDBM_STATIC void CMDBM_PoolAdaptProc(void *data)
+{
+    CMDBM_Pool *pool = (CMDBM_Pool*)data;
+    uint32_t total = CMDBM_AtomicLoad(&pool->total);
+    uint32_t idle = CMDBM_AtomicLoad(&pool->nidle);
+    uint32_t inuse = total > idle? total - idle:0;
+    uint32_t limit, next, pwait, waits, checkouts, headroom;
+    void *resource = NULL;
+
+    if (inuse > pool->usepeak)
+        pool->usepeak = inuse;
+    if (++pool->samples < CMDBM_POOL_ADAPT_WINDOW)
+        return;
+    checkouts = CMDBM_AtomicLoad(&pool->checkouts);
+    CMDBM_AtomicAdd(&pool->checkouts, (uint32_t)-checkouts);
+    CMCall(pool->waitmtx, Lock);
+    waits = pool->winwaits;
+    // counter is sampled before queued checkouts it includes are recorded.
+    if (checkouts < waits)
+        checkouts = waits;
+    pwait = CMDBM_PoolPercentile(
+                pool, pool->winhist, checkouts, pool->targetpct);
+    memset(pool->winhist, 0x0, sizeof(pool->winhist));
+    pool->winwaits = 0;
+    CMCall(pool->waitmtx, Unlock);
+
+    limit = next = CMDBM_AtomicLoad(&pool->limit);
+    pool->utilization = pool->usepeak * 100 / limit;
+    headroom = CMDBM_AtomicLoad(&pool->opencost) > pool->targetwait? 4:2;
+    if (pwait > pool->targetwait && limit < pool->maxcnt) {
+        next = limit + (limit / 4 > 0? limit / 4:1);
+        if (next > pool->maxcnt)
+            next = pool->maxcnt;
+        pool->grows++;
+        CMLogInfo("pool '%s' limit %u -> %u, p%u wait %u ms, %u%% used.",
+                  pool->name, limit, next, pool->targetpct, pwait,
+                  pool->utilization);
+    } else if (waits == 0 && limit > pool->mincnt &&
+               pool->usepeak * headroom < limit) {
+        next = limit - 1;
+        pool->shrinks++;
+        CMLogInfo("pool '%s' limit %u -> %u, %u%% used.",
+                  pool->name, limit, next, pool->utilization);
+    }
+    pool->samples = 0;
+    pool->usepeak = inuse;
+    if (next == limit)
+        return;
+    CMDBM_AtomicStore(&pool->limit, next);
+    if (next > limit) {
+        // queued checkouts may create up to the new limit.
+        CMDBM_PoolNotify(pool);
+        CMDBM_PoolWakeOpener(pool);
+        return;
+    }
+    // closes idle resources over the limit, busy ones on later rounds.
+    while (CMDBM_AtomicLoad(&pool->total) > next &&
+           CMDBM_PoolPopIdle(pool, &resource, NULL))
+        CMDBM_PoolDiscard(pool, resource);
+}
+
+// period of maintenance task, zero if there is nothing to maintain.
+CMDBM_STATIC long CMDBM_PoolTick(CMDBM_Pool *pool)
+{
+    int64_t res = pool->pingterm;
+    if (pool->idletimeout > 0 &&
+            (res == 0 || pool->idletimeout / 2 < res))
+        res = pool->idletimeout / 2;
+    // jitter window is 1/8 of lifetime, checks twice within it.
+    if (pool->maxlifetime > 0 &&
+            (res == 0 || pool->maxlifetime / 16 < res))
+        res = pool->maxlifetime / 16;
+    if ((pool->minidle > 0 || pool->brkthreshold > 0) && res == 0)
+        res = CMDBM_POOL_TICK_MAX;
+    if (res == 0)
+        return 0;
+    if (res < CMDBM_POOL_TICK_MIN)
+        res = CMDBM_POOL_TICK_MIN;
+    if (res > CMDBM_POOL_TICK_MAX)
+        res = CMDBM_POOL_TICK_MAX;
+    return (long)res;
+}
+
+CMDBM_Pool *CMDBM_PoolCreate(
+        const char *name,
+        const CMDBM_PoolConfig *conf,
+        void *(*createf)(void*),
+        void (*destroyf)(void*, void*),
+        CMBool (*testf)(void*, void*),
+        void *udata,
+        CMUTIL_Timer *timer)
+{
+    uint32_t i, initcnt = conf->initcnt, maxcnt = conf->maxcnt;
+    long period;
+    CMDBM_Pool *res = NULL;
+    if (maxcnt == 0) {
+        CMLogError("maximum pool size must be greater than zero.");
+        return NULL;
+    }
+    if (initcnt > maxcnt)
+        initcnt = maxcnt;
+    res = CMAlloc(sizeof(CMDBM_Pool));
+    memset(res, 0x0, sizeof(CMDBM_Pool));
+    res->name = CMStrdup(name);
+    res->maxcnt = res->limit = maxcnt;
+    if (conf->targetwait > 0 && timer) {
+        res->targetwait = conf->targetwait;
+        res->targetpct = conf->targetpct > 0 && conf->targetpct <= 100?
+                    conf->targetpct:99;
+        res->mincnt = conf->mincnt > 0? conf->mincnt:initcnt;
+        if (res->mincnt == 0)
+            res->mincnt = 1;
+        if (res->mincnt > maxcnt)
+            res->mincnt = maxcnt;
+        res->limit = initcnt > res->mincnt? initcnt:res->mincnt;
+    } else if (conf->targetwait > 0) {
+        CMLogError("adaptive pool sizing needs a timer, size is fixed.");
+    }
+    res->testonborrow = conf->testonborrow;
+    res->testidle = conf->testidle;
+    res->idletimeout = conf->idletimeout;
+    res->minidle = conf->minidle > maxcnt? maxcnt:conf->minidle;
+    res->maxlifetime = conf->maxlifetime;
+    if (conf->breakerthreshold > 0) {
+        res->brkthreshold = conf->breakerthreshold;
+        res->brkbackoff = conf->breakerbackoff > 0? conf->breakerbackoff:1000;
+        res->brkmaxbackoff = conf->breakermaxbackoff > res->brkbackoff?
+                    conf->breakermaxbackoff:res->brkbackoff;
+        res->backoff = res->brkbackoff;
+        res->brkmtx = CMUTIL_MutexCreate();
+    }
+    if (conf->pingtest)
+        res->pingterm = (int64_t)conf->pingterm * 1000;
+    res->createf = createf;
+    res->destroyf = destroyf;
+    res->testf = testf;
+    res->udata = udata;
+    res->poolid = CMDBM_AtomicAdd(&g_cmdbm_pool_seq, 1) + 1;
+    res->nslots = maxcnt * 2;
+    res->slots = CMAlloc(sizeof(CMDBM_PoolSlot) * res->nslots);
+    memset(res->slots, 0x0, sizeof(CMDBM_PoolSlot) * res->nslots);
+    res->waitmtx = CMUTIL_MutexCreate();
+    if (res->maxlifetime > 0) {
+        res->lifemtx = CMUTIL_MutexCreate();
+        res->lives = CMAlloc(sizeof(CMDBM_PoolLife) * maxcnt);
+    }
+    for (i=res->nslots; i>0; i--)
+        CMDBM_PoolPush(res, &res->free, i - 1);
+
+    CMDBM_PoolWarmUp(res, initcnt);
+    if (res->minidle > 0) {
+        res->opensem = CMUTIL_SemaphoreCreate(0);
+        res->opener = CMUTIL_ThreadCreate(
+                    CMDBM_PoolOpenProc, res, "cmdbm-pool-opener");
+        if (!CMCall(res->opener, Start)) {
+            CMLogError("cannot start pool opener thread.");
+            CMCall(res->opener, Join);
+            res->opener = NULL;
+        }
+        CMDBM_PoolWakeOpener(res);
+    }
+    period = CMDBM_PoolTick(res);
+    if (timer && period > 0)
+        res->maintask = CMCall(timer, ScheduleDelayRepeat, period, period,
+                               CMTrue, CMDBM_PoolMaintainProc, res);
+    if (conf->threadcache > 0)
+        CMDBM_PoolSetThreadCache(res, conf->threadcache, timer);
+    if (res->targetwait > 0)
+        res->adapttask = CMCall(timer, ScheduleDelayRepeat,
+                                CMDBM_POOL_ADAPT_TICK, CMDBM_POOL_ADAPT_TICK,
+                                CMTrue, CMDBM_PoolAdaptProc, res);
+    return res;
+}
+
+void CMDBM_PoolDestroy(CMDBM_Pool *pool)
+{
+    if (pool) {
+        uint32_t i;
+        void *resource = NULL;
+        if (pool->maintask) CMCall(pool->maintask, Cancel);
+        if (pool->adapttask) CMCall(pool->adapttask, Cancel);
+        if (pool->opener) {
+            CMDBM_AtomicStore(&pool->stop, 1);
+            CMCall(pool->opensem, Release);
+            CMCall(pool->opener, Join);
+        }
+        if (pool->opensem) CMCall(pool->opensem, Destroy);
+        if (pool->sweeptask) CMCall(pool->sweeptask, Cancel);
+        if (pool->caches) {
+            CMDBM_PoolReclaim(pool, 0, CMFalse);
+            // threads still holding a cache free it when they drop it.
+            for (i=0; i<(uint32_t)CMCall(pool->caches, GetSize); i++)
+                CMDBM_PoolCacheUnref((CMDBM_PoolCache*)CMCall(
+                            pool->caches, GetAt, i));
+            CMCall(pool->caches, Destroy);
+            CMCall(pool->cachemtx, Destroy);
+        }
+        while (CMDBM_PoolPopIdle(pool, &resource, NULL))
+            CMDBM_PoolDiscard(pool, resource);
+        if (CMDBM_AtomicLoad(&pool->total) > 0)
+            CMLogWarn("pool destroyed with %u resources checked out.",
+                      CMDBM_AtomicLoad(&pool->total));
+        CMCall(pool->waitmtx, Destroy);
+        if (pool->brkmtx) CMCall(pool->brkmtx, Destroy);
+        if (pool->lives) {
+            CMFree(pool->lives);
+            CMCall(pool->lifemtx, Destroy);
+        }
+        CMFree(pool->slots);
+        CMFree(pool->name);
+        CMFree(pool);
+    }
+}
@@ -0,0 +1,119 @@
+
+#include "functions.h"
+
+CMUTIL_LogDefine("cmdbm.prefetch")
+
+// number of row batches in flight, one filled while the other is consumed.
+#define CMDBM_PREFETCH_BATCHES  2
+#define CMDBM_PREFETCH_WAIT     100
+
+typedef struct CMDBM_PrefetchBatch {
+    CMUTIL_JsonObject   **rows;
+    uint32_t            count;
+    CMBool              last;
+} CMDBM_PrefetchBatch;
+
+typedef struct CMDBM_Prefetcher {
+    CMDBM_Connection    *conn;
+    CMDBM_Cursor        *cursor;
+    CMUTIL_Semaphore    *empty;     // batches free to fill
+    CMUTIL_Semaphore    *full;      // batches ready to consume
+    CMDBM_PrefetchBatch batches[CMDBM_PREFETCH_BATCHES];
+    uint32_t            batchrows;
+    volatile CMBool     stop;
+} CMDBM_Prefetcher;
+
+CMDBM_STATIC void *CMDBM_PrefetchProc(void *udata)
+{
+    CMDBM_Prefetcher *pf = (CMDBM_Prefetcher*)udata;
+    uint32_t tail = 0;
+    CMBool last = CMFalse;
+    // some client libraries need per thread setup for the connection.
+    CMCall(pf->conn, ThreadInit);
+    while (!last) {
+        CMDBM_PrefetchBatch *batch = NULL;
+        CMUTIL_JsonObject *row = NULL;
+        while (!CMCall(pf->empty, Acquire, CMDBM_PREFETCH_WAIT))
+            if (pf->stop) goto ENDPOINT;
+        if (pf->stop)
+            goto ENDPOINT;
+        batch = &(pf->batches[tail]);
+        batch->count = 0;
+        while (batch->count < pf->batchrows &&
+               (row = CMCall(pf->cursor, GetNext)) != NULL)
+            batch->rows[batch->count++] = row;
+        // short batch means end of result or fetch failure.
+        last = batch->count < pf->batchrows? CMTrue:CMFalse;
+        batch->last = last;
+        tail = (tail + 1) % CMDBM_PREFETCH_BATCHES;
+        CMCall(pf->full, Release);
+    }
+ENDPOINT:
+    CMCall(pf->conn, ThreadEnd);
+    return NULL;
+}
+
+CMDBM_STATIC void CMDBM_PrefetchDiscard(CMDBM_PrefetchBatch *batch)
+{
+    uint32_t i;
+    for (i=0; i<batch->count; i++)
+        CMUTIL_JsonDestroy(batch->rows[i]);
+    batch->count = 0;
+}
+
+CMBool CMDBM_PrefetchForEach(
+        CMDBM_Connection *conn,
+        CMDBM_Cursor *cursor, uint32_t batchrows, void *udata,
+        CMBool (*rowcb)(CMUTIL_JsonObject*, uint32_t, void*))
+{
+    uint32_t i, head = 0, idx = 0;
+    CMBool cont = CMTrue, last = CMFalse;
+    CMUTIL_Thread *thread = NULL;
+    CMDBM_Prefetcher *pf = CMAlloc(sizeof(CMDBM_Prefetcher));
+    memset(pf, 0x0, sizeof(CMDBM_Prefetcher));
+    pf->conn = conn;
+    pf->cursor = cursor;
+    pf->batchrows = batchrows > 0? batchrows:1;
+    pf->empty = CMUTIL_SemaphoreCreate(CMDBM_PREFETCH_BATCHES);
+    pf->full = CMUTIL_SemaphoreCreate(0);
+    for (i=0; i<CMDBM_PREFETCH_BATCHES; i++)
+        pf->batches[i].rows =
+                CMAlloc(sizeof(CMUTIL_JsonObject*) * pf->batchrows);
+
+    thread = CMUTIL_ThreadCreate(CMDBM_PrefetchProc, pf, "cmdbm-prefetch");
+    if (!CMCall(thread, Start)) {
+        CMLogError("cannot start prefetch thread.");
+        cont = CMFalse;
+        CMCall(thread, Join);
+        goto ENDPOINT;
+    }
+
+    while (cont && !last) {
+        CMDBM_PrefetchBatch *batch = NULL;
+        while (!CMCall(pf->full, Acquire, CMDBM_PREFETCH_WAIT));
+        batch = &(pf->batches[head]);
+        for (i=0; i<batch->count; i++) {
+            if (cont)
+                cont = rowcb(batch->rows[i], idx++, udata);
+            CMUTIL_JsonDestroy(batch->rows[i]);
+        }
+        batch->count = 0;
+        last = batch->last;
+        head = (head + 1) % CMDBM_PREFETCH_BATCHES;
+        CMCall(pf->empty, Release);
+    }
+
+    // stops producer if callback ended iteration early.
+    pf->stop = CMTrue;
+    CMCall(thread, Join);
+    cont = CMTrue;
+ENDPOINT:
+    for (i=0; i<CMDBM_PREFETCH_BATCHES; i++) {
+        CMDBM_PrefetchDiscard(&(pf->batches[i]));
+        CMFree(pf->batches[i].rows);
+    }
+    CMCall(pf->empty, Destroy);
+    CMCall(pf->full, Destroy);
+    CMFree(pf);
+    return cont;
+}
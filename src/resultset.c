@@ -0,0 +1,950 @@
+
+// spill offsets may exceed 2GB, so ask for a 64-bit off_t where long is
+// 32 bits. this must come before any system header.
+#if !defined(_FILE_OFFSET_BITS)
+# define _FILE_OFFSET_BITS 64
+#endif
+
+#include "mapper.h"
+
+CMUTIL_LogDefine("cmdbm.resultset")
+
+// string values are copied into blocks of this size.
+#define CMDBM_RESULTSET_BLOCK   65536
+// spilled rows are read back in pages of this many rows.
+#define CMDBM_RESULTSET_PAGE    256
+
+CMDBM_STATIC int CMDBM_ResultSetSeek(FILE *fp, uint64_t offset)
+{
+#if defined(MSWIN)
+    return _fseeki64(fp, (__int64)offset, SEEK_SET);
+#else
+    return fseeko(fp, (off_t)offset, SEEK_SET);
+#endif
+}
+
+typedef struct CMDBM_ResultCell {
+    union {
+        int64_t         lval;
+        double          dval;
+        CMBool          bval;
+        const char      *sval;
+    } u;
+    CMJsonValueType     type;
+    uint32_t            length;
+} CMDBM_ResultCell;
+
+typedef struct CMDBM_ResultSet_Internal {
+    CMDBM_ResultSet     base;
+    char                **names;
+    CMUTIL_Map          *nameidx;
+    CMDBM_ResultCell    *cells;
+    size_t              cellcap;
+    CMUTIL_List         *blocks;
+    char                *block;
+    size_t              blockused;
+    size_t              blocksize;
+    size_t              memlimit;   // zero for no limit
+    size_t              memused;
+    FILE                *spill;     // rows over memory limit
+    uint64_t            *offsets;   // file offsets of spilled rows and end
+    size_t              offcap;
+    CMDBM_ResultCell    *page;      // cached page of spilled rows
+    size_t              pagecap;
+    char                *pagebuf;
+    size_t              pagebufcap;
+    uint32_t            colcnt;
+    uint32_t            rowcnt;
+    uint32_t            memrows;    // rows kept in memory
+    uint32_t            pagefirst;
+    uint32_t            pagerows;
+    int                 dummy_padder;
+} CMDBM_ResultSet_Internal;
+
+int64_t CMDBM_ValueToLong(const CMDBM_ColumnValue *val)
+{
+    switch (val->type) {
+    case CMJsonValueLong:    return val->u.lval;
+    case CMJsonValueDouble:  return (int64_t)val->u.dval;
+    case CMJsonValueBoolean: return val->u.bval? 1:0;
+    case CMJsonValueString:  return strtoll(val->u.sval, NULL, 10);
+    default: return 0;
+    }
+}
+
+double CMDBM_ValueToDouble(const CMDBM_ColumnValue *val)
+{
+    switch (val->type) {
+    case CMJsonValueLong:    return (double)val->u.lval;
+    case CMJsonValueDouble:  return val->u.dval;
+    case CMJsonValueBoolean: return val->u.bval? 1.0:0.0;
+    case CMJsonValueString:  return strtod(val->u.sval, NULL);
+    default: return 0.0;
+    }
+}
+
+CMBool CMDBM_ValueToBoolean(const CMDBM_ColumnValue *val)
+{
+    switch (val->type) {
+    case CMJsonValueLong:    return val->u.lval? CMTrue:CMFalse;
+    case CMJsonValueDouble:  return val->u.dval != 0.0? CMTrue:CMFalse;
+    case CMJsonValueBoolean: return val->u.bval;
+    case CMJsonValueString:
+        return (strcasecmp(val->u.sval, "true") == 0 ||
+                strcmp(val->u.sval, "1") == 0)? CMTrue:CMFalse;
+    default: return CMFalse;
+    }
+}
+
+CMDBM_STATIC CMBool CMDBM_ResultSetLoadPage(
+        CMDBM_ResultSet_Internal *irs, uint32_t row)
+{
+    uint32_t i, j, first, rows, sidx;
+    size_t size;
+    const char *p = NULL;
+    // pages are aligned from the first spilled row.
+    first = row - (row - irs->memrows) % CMDBM_RESULTSET_PAGE;
+    rows = irs->rowcnt - first;
+    if (rows > CMDBM_RESULTSET_PAGE)
+        rows = CMDBM_RESULTSET_PAGE;
+    sidx = first - irs->memrows;
+    size = (size_t)(irs->offsets[sidx + rows] - irs->offsets[sidx]);
+    irs->pagerows = 0;
+    irs->pagebuf = (char*)CMDBM_BufferGrow(
+                irs->pagebuf, &irs->pagebufcap, size, 0);
+    irs->page = (CMDBM_ResultCell*)CMDBM_BufferGrow(
+                irs->page, &irs->pagecap,
+                sizeof(CMDBM_ResultCell) * rows * irs->colcnt, 0);
+    if (CMDBM_ResultSetSeek(irs->spill, irs->offsets[sidx]) != 0 ||
+            fread(irs->pagebuf, 1, size, irs->spill) != size) {
+        CMLogErrorS("cannot read spilled rows from temporary file.");
+        return CMFalse;
+    }
+    p = irs->pagebuf;
+    for (i=0; i<rows; i++) {
+        for (j=0; j<irs->colcnt; j++) {
+            CMDBM_ResultCell *cell =
+                    &(irs->page[(size_t)i * irs->colcnt + j]);
+            cell->type = (CMJsonValueType)(uint8_t)*p++;
+            cell->length = 0;
+            switch (cell->type) {
+            case CMJsonValueLong:
+                memcpy(&cell->u.lval, p, sizeof(int64_t));
+                p += sizeof(int64_t);
+                break;
+            case CMJsonValueDouble:
+                memcpy(&cell->u.dval, p, sizeof(double));
+                p += sizeof(double);
+                break;
+            case CMJsonValueBoolean:
+                cell->u.bval = *p++? CMTrue:CMFalse;
+                break;
+            case CMJsonValueString:
+                // written with terminator, so used in place.
+                memcpy(&cell->length, p, sizeof(uint32_t));
+                p += sizeof(uint32_t);
+                cell->u.sval = p;
+                p += cell->length + 1;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    irs->pagefirst = first;
+    irs->pagerows = rows;
+    return CMTrue;
+}
+
+CMDBM_STATIC CMDBM_ResultCell *CMDBM_ResultSetCell(
+        const CMDBM_ResultSet *rs, uint32_t row, uint32_t col)
+{
+    // page cache is updated even through const handle.
+    CMDBM_ResultSet_Internal *irs = (CMDBM_ResultSet_Internal*)rs;
+    if (row >= irs->rowcnt || col >= irs->colcnt) {
+        CMLogErrorS("result set index out of range: row %u, column %u.",
+                    row, col);
+        return NULL;
+    }
+    if (row < irs->memrows)
+        return &(irs->cells[(size_t)row * irs->colcnt + col]);
+    if (irs->pagerows == 0 || row < irs->pagefirst ||
+            row >= irs->pagefirst + irs->pagerows) {
+        if (!CMDBM_ResultSetLoadPage(irs, row))
+            return NULL;
+    }
+    return &(irs->page[(size_t)(row - irs->pagefirst) * irs->colcnt + col]);
+}
+
+CMDBM_STATIC uint32_t CMDBM_ResultSetGetColumnCount(
+        const CMDBM_ResultSet *rs)
+{
+    const CMDBM_ResultSet_Internal *irs = (const CMDBM_ResultSet_Internal*)rs;
+    return irs->colcnt;
+}
+
+CMDBM_STATIC const char *CMDBM_ResultSetGetColumnName(
+        const CMDBM_ResultSet *rs, uint32_t col)
+{
+    const CMDBM_ResultSet_Internal *irs = (const CMDBM_ResultSet_Internal*)rs;
+    return col < irs->colcnt? irs->names[col]:NULL;
+}
+
+CMDBM_STATIC int CMDBM_ResultSetGetColumnIndex(
+        const CMDBM_ResultSet *rs, const char *name)
+{
+    const CMDBM_ResultSet_Internal *irs = (const CMDBM_ResultSet_Internal*)rs;
+    // stored as index + 1, so missing name gives -1.
+    return (int)((intptr_t)CMCall(irs->nameidx, Get, name)) - 1;
+}
+
+CMDBM_STATIC uint32_t CMDBM_ResultSetGetRowCount(
+        const CMDBM_ResultSet *rs)
+{
+    const CMDBM_ResultSet_Internal *irs = (const CMDBM_ResultSet_Internal*)rs;
+    return irs->rowcnt;
+}
+
+CMDBM_STATIC CMJsonValueType CMDBM_ResultSetGetType(
+        const CMDBM_ResultSet *rs, uint32_t row, uint32_t col)
+{
+    CMDBM_ResultCell *cell = CMDBM_ResultSetCell(rs, row, col);
+    return cell? cell->type:CMJsonValueNull;
+}
+
+CMDBM_STATIC CMBool CMDBM_ResultSetIsNull(
+        const CMDBM_ResultSet *rs, uint32_t row, uint32_t col)
+{
+    CMDBM_ResultCell *cell = CMDBM_ResultSetCell(rs, row, col);
+    return (!cell || cell->type == CMJsonValueNull)? CMTrue:CMFalse;
+}
+
+CMDBM_STATIC CMBool CMDBM_ResultSetValue(
+        const CMDBM_ResultSet *rs, uint32_t row, uint32_t col,
+        CMDBM_ColumnValue *val)
+{
+    CMDBM_ResultCell *cell = CMDBM_ResultSetCell(rs, row, col);
+    if (cell == NULL)
+        return CMFalse;
+    val->type = cell->type;
+    val->length = cell->length;
+    switch (cell->type) {
+    case CMJsonValueLong:    val->u.lval = cell->u.lval; break;
+    case CMJsonValueDouble:  val->u.dval = cell->u.dval; break;
+    case CMJsonValueBoolean: val->u.bval = cell->u.bval; break;
+    default:                 val->u.sval = cell->u.sval; break;
+    }
+    return CMTrue;
+}
+
+CMDBM_STATIC int64_t CMDBM_ResultSetGetLong(
+        const CMDBM_ResultSet *rs, uint32_t row, uint32_t col)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_ResultSetValue(rs, row, col, &val))
+        return CMDBM_ValueToLong(&val);
+    return 0;
+}
+
+CMDBM_STATIC double CMDBM_ResultSetGetDouble(
+        const CMDBM_ResultSet *rs, uint32_t row, uint32_t col)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_ResultSetValue(rs, row, col, &val))
+        return CMDBM_ValueToDouble(&val);
+    return 0.0;
+}
+
+CMDBM_STATIC CMBool CMDBM_ResultSetGetBoolean(
+        const CMDBM_ResultSet *rs, uint32_t row, uint32_t col)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_ResultSetValue(rs, row, col, &val))
+        return CMDBM_ValueToBoolean(&val);
+    return CMFalse;
+}
+
+CMDBM_STATIC const char *CMDBM_ResultSetGetString(
+        const CMDBM_ResultSet *rs, uint32_t row, uint32_t col, size_t *length)
+{
+    CMDBM_ResultCell *cell = CMDBM_ResultSetCell(rs, row, col);
+    if (cell && cell->type == CMJsonValueString) {
+        if (length) *length = cell->length;
+        return cell->u.sval;
+    }
+    if (length) *length = 0;
+    return NULL;
+}
+
+CMDBM_STATIC CMUTIL_JsonObject *CMDBM_ResultSetGetRowObject(
+        const CMDBM_ResultSet *rs, uint32_t row)
+{
+    const CMDBM_ResultSet_Internal *irs = (const CMDBM_ResultSet_Internal*)rs;
+    CMUTIL_JsonObject *res = NULL;
+    uint32_t i;
+    if (row >= irs->rowcnt)
+        return NULL;
+    res = CMUTIL_JsonObjectCreate();
+    for (i=0; i<irs->colcnt; i++) {
+        CMDBM_ResultCell *cell = CMDBM_ResultSetCell(rs, row, i);
+        if (cell == NULL) {
+            CMUTIL_JsonDestroy(res);
+            return NULL;
+        }
+        switch (cell->type) {
+        case CMJsonValueLong:
+            CMCall(res, PutLong, irs->names[i], cell->u.lval);
+            break;
+        case CMJsonValueDouble:
+            CMCall(res, PutDouble, irs->names[i], cell->u.dval);
+            break;
+        case CMJsonValueBoolean:
+            CMCall(res, PutBoolean, irs->names[i], cell->u.bval);
+            break;
+        case CMJsonValueString:
+            CMCall(res, PutString, irs->names[i], cell->u.sval);
+            break;
+        default:
+            CMCall(res, PutNull, irs->names[i]);
+        }
+    }
+    return res;
+}
+
+CMDBM_STATIC void CMDBM_ResultSetDestroy(
+        CMDBM_ResultSet *rs)
+{
+    CMDBM_ResultSet_Internal *irs = (CMDBM_ResultSet_Internal*)rs;
+    if (irs) {
+        if (irs->names) {
+            uint32_t i;
+            for (i=0; i<irs->colcnt; i++)
+                if (irs->names[i]) CMFree(irs->names[i]);
+            CMFree(irs->names);
+        }
+        if (irs->nameidx) CMCall(irs->nameidx, Destroy);
+        if (irs->cells) CMFree(irs->cells);
+        if (irs->blocks) CMCall(irs->blocks, Destroy);
+        if (irs->spill) fclose(irs->spill);
+        if (irs->offsets) CMFree(irs->offsets);
+        if (irs->page) CMFree(irs->page);
+        if (irs->pagebuf) CMFree(irs->pagebuf);
+        CMFree(irs);
+    }
+}
+
+CMDBM_STATIC const char *CMDBM_ResultSetCopyString(
+        CMDBM_ResultSet_Internal *irs, const char *str, size_t len)
+{
+    char *res = NULL;
+    if (irs->block == NULL || irs->blockused + len + 1 > irs->blocksize) {
+        irs->blocksize = len + 1 > CMDBM_RESULTSET_BLOCK?
+                    len + 1:CMDBM_RESULTSET_BLOCK;
+        irs->block = CMAlloc(irs->blocksize);
+        irs->blockused = 0;
+        CMCall(irs->blocks, AddTail, irs->block);
+    }
+    res = irs->block + irs->blockused;
+    memcpy(res, str, len);
+    res[len] = 0x0;
+    irs->blockused += len + 1;
+    return res;
+}
+
+CMDBM_STATIC void CMDBM_ResultSetStoreRow(
+        CMDBM_ResultSet_Internal *irs, const CMDBM_ColumnValue *vals)
+{
+    uint32_t i;
+    CMDBM_ResultCell *row = NULL;
+    size_t need = ((size_t)irs->rowcnt + 1) * irs->colcnt;
+    irs->cells = (CMDBM_ResultCell*)CMDBM_BufferGrow(
+                irs->cells, &irs->cellcap,
+                need * sizeof(CMDBM_ResultCell),
+                (need - irs->colcnt) * sizeof(CMDBM_ResultCell));
+    row = &(irs->cells[(size_t)irs->rowcnt * irs->colcnt]);
+    irs->memused += sizeof(CMDBM_ResultCell) * irs->colcnt;
+    for (i=0; i<irs->colcnt; i++) {
+        CMDBM_ResultCell *cell = &row[i];
+        memset(cell, 0x0, sizeof(CMDBM_ResultCell));
+        cell->type = vals[i].type;
+        switch (vals[i].type) {
+        case CMJsonValueLong:    cell->u.lval = vals[i].u.lval; break;
+        case CMJsonValueDouble:  cell->u.dval = vals[i].u.dval; break;
+        case CMJsonValueBoolean: cell->u.bval = vals[i].u.bval; break;
+        case CMJsonValueString:
+            cell->u.sval = CMDBM_ResultSetCopyString(
+                        irs, vals[i].u.sval, vals[i].length);
+            cell->length = (uint32_t)vals[i].length;
+            irs->memused += vals[i].length + 1;
+            break;
+        default: break;
+        }
+    }
+    irs->memrows++;
+}
+
+/*
+ * Appends row to spill file. Each value is written as one type byte
+ * followed by 8 byte number, 1 byte boolean or 4 byte length and
+ * null terminated string.
+ */
+CMDBM_STATIC CMBool CMDBM_ResultSetSpillRow(
+        CMDBM_ResultSet_Internal *irs, const CMDBM_ColumnValue *vals)
+{
+    uint32_t i;
+    size_t sidx = irs->rowcnt - irs->memrows;
+    uint64_t pos = irs->offsets? irs->offsets[sidx]:0;
+    CMBool succ = CMTrue;
+    for (i=0; succ && i<irs->colcnt; i++) {
+        uint8_t type = (uint8_t)vals[i].type;
+        uint8_t bval = 0;
+        uint32_t len = 0;
+        succ = fwrite(&type, 1, 1, irs->spill) == 1;
+        pos += 1;
+        switch (vals[i].type) {
+        case CMJsonValueLong:
+            succ = succ && fwrite(&vals[i].u.lval,
+                                  sizeof(int64_t), 1, irs->spill) == 1;
+            pos += sizeof(int64_t);
+            break;
+        case CMJsonValueDouble:
+            succ = succ && fwrite(&vals[i].u.dval,
+                                  sizeof(double), 1, irs->spill) == 1;
+            pos += sizeof(double);
+            break;
+        case CMJsonValueBoolean:
+            bval = vals[i].u.bval? 1:0;
+            succ = succ && fwrite(&bval, 1, 1, irs->spill) == 1;
+            pos += 1;
+            break;
+        case CMJsonValueString:
+            len = (uint32_t)vals[i].length;
+            succ = succ && fwrite(&len, sizeof(uint32_t), 1, irs->spill) == 1;
+            succ = succ && fwrite(vals[i].u.sval, 1, len, irs->spill) == len;
+            succ = succ && fwrite("", 1, 1, irs->spill) == 1;
+            pos += sizeof(uint32_t) + len + 1;
+            break;
+        default:
+            break;
+        }
+    }
+    if (!succ) {
+        CMLogErrorS("cannot write spilled row to temporary file.");
+        return CMFalse;
+    }
+    // offsets keep start of each spilled row and end of the last one.
+    irs->offsets = (uint64_t*)CMDBM_BufferGrow(
+                irs->offsets, &irs->offcap,
+                sizeof(uint64_t) * (sidx + 2), sizeof(uint64_t) * (sidx + 1));
+    if (sidx == 0)
+        irs->offsets[0] = 0;
+    irs->offsets[sidx + 1] = pos;
+    return CMTrue;
+}
+
+static CMDBM_ResultSet g_cmdbm_resultset = {
+    CMDBM_ResultSetGetColumnCount,
+    CMDBM_ResultSetGetColumnName,
+    CMDBM_ResultSetGetColumnIndex,
+    CMDBM_ResultSetGetRowCount,
+    CMDBM_ResultSetGetType,
+    CMDBM_ResultSetIsNull,
+    CMDBM_ResultSetGetLong,
+    CMDBM_ResultSetGetDouble,
+    CMDBM_ResultSetGetBoolean,
+    CMDBM_ResultSetGetString,
+    CMDBM_ResultSetGetRowObject,
+    CMDBM_ResultSetDestroy
+};
+
+CMDBM_ResultSet *CMDBM_ResultSetCreate(CMDBM_Cursor *cursor, size_t memlimit)
+{
+    uint32_t i;
+    CMDBM_ColumnValue *vals = NULL;
+    CMDBM_ResultSet_Internal *res = CMAlloc(sizeof(CMDBM_ResultSet_Internal));
+    memset(res, 0x0, sizeof(CMDBM_ResultSet_Internal));
+    memcpy(res, &g_cmdbm_resultset, sizeof(CMDBM_ResultSet));
+    res->nameidx = CMUTIL_MapCreate();
+    res->blocks = CMUTIL_ListCreateEx(CMFree);
+    res->memlimit = memlimit;
+
+    // column names are copied once for the whole result.
+    res->colcnt = CMCall(cursor, GetColumnCount);
+    if (res->colcnt == 0)
+        goto FAILED;
+    res->names = CMAlloc(sizeof(char*) * res->colcnt);
+    memset(res->names, 0x0, sizeof(char*) * res->colcnt);
+    for (i=0; i<res->colcnt; i++) {
+        const char *name = CMCall(cursor, GetColumnName, i);
+        res->names[i] = CMStrdup(name? name:"");
+        CMCall(res->nameidx, Put, res->names[i], (void*)(intptr_t)(i+1), NULL);
+    }
+
+    vals = CMAlloc(sizeof(CMDBM_ColumnValue) * res->colcnt);
+    while (CMCall(cursor, Fetch)) {
+        for (i=0; i<res->colcnt; i++) {
+            if (!CMCall(cursor, GetValue, i, &vals[i])) {
+                CMLogErrorS("cannot read column '%s' of row %u.",
+                            res->names[i], res->rowcnt);
+                goto FAILED;
+            }
+        }
+        if (res->spill == NULL && res->memlimit > 0 &&
+                res->memused >= res->memlimit) {
+            // following rows go to disk.
+            res->spill = tmpfile();
+            if (res->spill == NULL) {
+                CMLogErrorS("cannot create temporary file for result set.");
+                goto FAILED;
+            }
+            CMLogInfo("result set exceeds memory limit %lu at row %u, "
+                      "spilling to disk.",
+                      (unsigned long)res->memlimit, res->rowcnt);
+        }
+        if (res->spill) {
+            if (!CMDBM_ResultSetSpillRow(res, vals))
+                goto FAILED;
+        } else {
+            CMDBM_ResultSetStoreRow(res, vals);
+        }
+        res->rowcnt++;
+    }
+    if (CMCall(cursor, HasFailed)) {
+        CMLogErrorS("fetching row %u of result set failed.", res->rowcnt);
+        goto FAILED;
+    }
+    if (res->spill && fflush(res->spill) != 0) {
+        CMLogErrorS("cannot flush spilled rows to temporary file.");
+        goto FAILED;
+    }
+    CMFree(vals);
+    return (CMDBM_ResultSet*)res;
+FAILED:
+    if (vals) CMFree(vals);
+    CMDBM_ResultSetDestroy((CMDBM_ResultSet*)res);
+    return NULL;
+}
+
+typedef struct CMDBM_Row_Internal {
+    CMDBM_Row           base;
+    CMDBM_Cursor        *cursor;
+    uint32_t            colcnt;
+    int                 dummy_padder;
+} CMDBM_Row_Internal;
+
+CMDBM_STATIC CMBool CMDBM_RowValue(
+        const CMDBM_Row *row, uint32_t col, CMDBM_ColumnValue *val)
+{
+    const CMDBM_Row_Internal *irow = (const CMDBM_Row_Internal*)row;
+    if (col >= irow->colcnt) {
+        CMLogErrorS("row column index out of range: %u.", col);
+        return CMFalse;
+    }
+    if (!CMCall(irow->cursor, GetValue, col, val)) {
+        CMLogErrorS("cannot read column %u of current row.", col);
+        return CMFalse;
+    }
+    return CMTrue;
+}
+
+CMDBM_STATIC uint32_t CMDBM_RowGetColumnCount(const CMDBM_Row *row)
+{
+    const CMDBM_Row_Internal *irow = (const CMDBM_Row_Internal*)row;
+    return irow->colcnt;
+}
+
+CMDBM_STATIC const char *CMDBM_RowGetColumnName(
+        const CMDBM_Row *row, uint32_t col)
+{
+    const CMDBM_Row_Internal *irow = (const CMDBM_Row_Internal*)row;
+    return CMCall(irow->cursor, GetColumnName, col);
+}
+
+CMDBM_STATIC CMJsonValueType CMDBM_RowGetType(
+        const CMDBM_Row *row, uint32_t col)
+{
+    CMDBM_ColumnValue val;
+    return CMDBM_RowValue(row, col, &val)? val.type:CMJsonValueNull;
+}
+
+CMDBM_STATIC CMBool CMDBM_RowIsNull(
+        const CMDBM_Row *row, uint32_t col)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_RowValue(row, col, &val))
+        return val.type == CMJsonValueNull? CMTrue:CMFalse;
+    return CMTrue;
+}
+
+CMDBM_STATIC int64_t CMDBM_RowGetLong(
+        const CMDBM_Row *row, uint32_t col)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_RowValue(row, col, &val))
+        return CMDBM_ValueToLong(&val);
+    return 0;
+}
+
+CMDBM_STATIC double CMDBM_RowGetDouble(
+        const CMDBM_Row *row, uint32_t col)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_RowValue(row, col, &val))
+        return CMDBM_ValueToDouble(&val);
+    return 0.0;
+}
+
+CMDBM_STATIC CMBool CMDBM_RowGetBoolean(
+        const CMDBM_Row *row, uint32_t col)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_RowValue(row, col, &val))
+        return CMDBM_ValueToBoolean(&val);
+    return CMFalse;
+}
+
+CMDBM_STATIC const char *CMDBM_RowGetStringView(
+        const CMDBM_Row *row, uint32_t col, size_t *length)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_RowValue(row, col, &val) && val.type == CMJsonValueString) {
+        if (length) *length = val.length;
+        return val.u.sval;
+    }
+    if (length) *length = 0;
+    return NULL;
+}
+
+CMDBM_STATIC CMDBM_ValueKind CMDBM_RowGetKind(
+        const CMDBM_Row *row, uint32_t col)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_RowValue(row, col, &val) && val.type != CMJsonValueNull)
+        return val.kind;
+    return CMDBM_ValuePlain;
+}
+
+CMDBM_STATIC CMBool CMDBM_RowGetTimestamp(
+        const CMDBM_Row *row, uint32_t col, CMDBM_Timestamp *ts)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_RowValue(row, col, &val) && val.type != CMJsonValueNull &&
+            val.kind == CMDBM_ValueTimestamp) {
+        *ts = val.native.ts;
+        return CMTrue;
+    }
+    return CMFalse;
+}
+
+CMDBM_STATIC CMBool CMDBM_RowGetDecimal(
+        const CMDBM_Row *row, uint32_t col, CMDBM_Decimal *dec)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_RowValue(row, col, &val) && val.type != CMJsonValueNull &&
+            val.kind == CMDBM_ValueDecimal) {
+        *dec = val.native.dec;
+        return CMTrue;
+    }
+    return CMFalse;
+}
+
+CMDBM_STATIC CMBool CMDBM_RowGetBinary(
+        const CMDBM_Row *row, uint32_t col, CMDBM_Binary *bin)
+{
+    CMDBM_ColumnValue val;
+    if (CMDBM_RowValue(row, col, &val) && val.type != CMJsonValueNull &&
+            val.kind == CMDBM_ValueBinary) {
+        *bin = val.native.bin;
+        return CMTrue;
+    }
+    return CMFalse;
+}
+
+typedef struct CMDBM_LobReader_Internal {
+    CMDBM_LobReader     base;
+    CMDBM_Cursor        *cursor;
+    uint32_t            col;
+    CMBool              restart;
+} CMDBM_LobReader_Internal;
+
+CMDBM_STATIC int64_t CMDBM_LobReaderRead(
+        CMDBM_LobReader *reader, void *buf, size_t size)
+{
+    CMDBM_LobReader_Internal *ird = (CMDBM_LobReader_Internal*)reader;
+    int64_t res = CMCall(ird->cursor, ReadLob, ird->col, ird->restart,
+                         buf, size);
+    ird->restart = CMFalse;
+    return res;
+}
+
+CMDBM_STATIC void CMDBM_LobReaderClose(CMDBM_LobReader *reader)
+{
+    if (reader) CMFree(reader);
+}
+
+CMDBM_STATIC CMDBM_LobReader *CMDBM_RowOpenLobReader(
+        const CMDBM_Row *row, uint32_t col)
+{
+    const CMDBM_Row_Internal *irow = (const CMDBM_Row_Internal*)row;
+    CMDBM_LobReader_Internal *res = NULL;
+    if (col >= irow->colcnt) {
+        CMLogErrorS("row column index out of range: %u.", col);
+        return NULL;
+    }
+    res = CMAlloc(sizeof(CMDBM_LobReader_Internal));
+    memset(res, 0x0, sizeof(CMDBM_LobReader_Internal));
+    res->base.Read = CMDBM_LobReaderRead;
+    res->base.Close = CMDBM_LobReaderClose;
+    res->cursor = irow->cursor;
+    res->col = col;
+    res->restart = CMTrue;
+    return (CMDBM_LobReader*)res;
+}
+
+static CMDBM_Row g_cmdbm_row = {
+    CMDBM_RowGetColumnCount,
+    CMDBM_RowGetColumnName,
+    CMDBM_RowGetType,
+    CMDBM_RowIsNull,
+    CMDBM_RowGetLong,
+    CMDBM_RowGetDouble,
+    CMDBM_RowGetBoolean,
+    CMDBM_RowGetStringView,
+    CMDBM_RowGetKind,
+    CMDBM_RowGetTimestamp,
+    CMDBM_RowGetDecimal,
+    CMDBM_RowGetBinary,
+    CMDBM_RowOpenLobReader
+};
+
+CMDBM_Row *CMDBM_RowCreate(CMDBM_Cursor *cursor)
+{
+    CMDBM_Row_Internal *res = CMAlloc(sizeof(CMDBM_Row_Internal));
+    memset(res, 0x0, sizeof(CMDBM_Row_Internal));
+    memcpy(res, &g_cmdbm_row, sizeof(CMDBM_Row));
+    res->cursor = cursor;
+    res->colcnt = CMCall(cursor, GetColumnCount);
+    return (CMDBM_Row*)res;
+}
+
+void CMDBM_RowDestroy(CMDBM_Row *row)
+{
+    if (row) CMFree(row);
+}
+
+typedef struct CMDBM_StructBinding {
+    const CMDBM_StructField *field;
+    uint32_t                col;
+    int                     dummy_padder;
+} CMDBM_StructBinding;
+
+struct CMDBM_StructBinder {
+    CMDBM_Cursor            *cursor;
+    CMDBM_StructType        *stype;
+    CMDBM_StructBinding     *bindings;
+    uint32_t                count;
+    int                     dummy_padder;
+};
+
+CMDBM_STATIC const char *CMDBM_StructBinderProperty(
+        CMUTIL_XmlNode *resultmap, const char *column)
+{
+    uint32_t i;
+    if (resultmap == NULL)
+        return column;
+    for (i=0; i<CMCall(resultmap, ChildCount); i++) {
+        CMUTIL_XmlNode *child = CMCall(resultmap, ChildAt, i);
+        CMUTIL_String *scol = NULL, *sprop = NULL;
+        if (CMDBM_MapperGetNodeType(child) != CMDBM_NTSqlResult)
+            continue;
+        scol = CMCall(child, GetAttribute, "column");
+        sprop = CMCall(child, GetAttribute, "property");
+        if (strcasecmp(CMCall(scol, GetCString), column) == 0)
+            return CMCall(sprop, GetCString);
+    }
+    // columns not listed in result map are matched by name.
+    return column;
+}
+
+CMDBM_STATIC CMDBM_StructType *CMDBM_StructBinderType(
+        CMDBM_DatabaseEx *db, const char *sqlid, CMUTIL_XmlNode **resultmap)
+{
+    CMUTIL_XmlNode *xqry = CMCall(db, GetQuery, sqlid);
+    CMUTIL_String *attr = NULL;
+    CMDBM_StructType *res = NULL;
+    *resultmap = NULL;
+    if (xqry == NULL)
+        return NULL;
+    attr = CMCall(xqry, GetAttribute, "resultMap");
+    if (attr) {
+        char idbuf[1024];
+        const char *mapid = CMCall(attr, GetCString);
+        const char *dot = strrchr(sqlid, '.');
+        // relative id is resolved in namespace of the query.
+        if (strchr(mapid, '.') == NULL && dot) {
+            snprintf(idbuf, sizeof(idbuf), "%.*s.%s",
+                     (int)(dot - sqlid), sqlid, mapid);
+            mapid = idbuf;
+        }
+        *resultmap = CMCall(db, GetQuery, mapid);
+        if (*resultmap == NULL ||
+                CMDBM_MapperGetNodeType(*resultmap) != CMDBM_NTSqlResultMap) {
+            CMLogErrorS("unknown resultMap '%s' in query %s.", mapid, sqlid);
+            return NULL;
+        }
+        attr = CMCall(*resultmap, GetAttribute, "type");
+    } else {
+        attr = CMCall(xqry, GetAttribute, "resultType");
+        if (attr == NULL) {
+            CMLogErrorS("query %s has neither resultMap nor resultType.",
+                        sqlid);
+            return NULL;
+        }
+    }
+    res = CMDBM_GetStructType(CMCall(attr, GetCString));
+    if (res == NULL)
+        CMLogErrorS("struct type '%s' is not registered.",
+                    CMCall(attr, GetCString));
+    return res;
+}
+
+CMDBM_StructBinder *CMDBM_StructBinderCreate(
+        CMDBM_Cursor *cursor, CMDBM_DatabaseEx *db, const char *sqlid)
+{
+    uint32_t i, j, colcnt = CMCall(cursor, GetColumnCount);
+    CMUTIL_XmlNode *resultmap = NULL;
+    CMDBM_StructBinder *res = NULL;
+    CMDBM_StructType *stype =
+            CMDBM_StructBinderType(db, sqlid, &resultmap);
+    if (stype == NULL || colcnt == 0)
+        return NULL;
+    res = CMAlloc(sizeof(CMDBM_StructBinder));
+    memset(res, 0x0, sizeof(CMDBM_StructBinder));
+    res->cursor = cursor;
+    res->stype = stype;
+    res->bindings = CMAlloc(sizeof(CMDBM_StructBinding) * colcnt);
+    for (i=0; i<colcnt; i++) {
+        const char *cname = CMCall(cursor, GetColumnName, i);
+        const char *prop = NULL;
+        if (cname == NULL)
+            continue;
+        prop = CMDBM_StructBinderProperty(resultmap, cname);
+        for (j=0; j<stype->count; j++) {
+            if (strcasecmp(stype->fields[j].name, prop) == 0) {
+                res->bindings[res->count].col = i;
+                res->bindings[res->count].field = &(stype->fields[j]);
+                res->count++;
+                break;
+            }
+        }
+        if (j == stype->count)
+            CMLogTrace("column %s has no field in struct %s, ignored.",
+                       cname, stype->name);
+    }
+    if (res->count == 0) {
+        CMLogErrorS("no column of result matches struct %s.", stype->name);
+        CMDBM_StructBinderDestroy(res);
+        res = NULL;
+    }
+    return res;
+}
+
+CMDBM_STATIC const char *CMDBM_StructBinderString(
+        const CMDBM_ColumnValue *val, char *buf, size_t bufsz, size_t *len)
+{
+    switch (val->type) {
+    case CMJsonValueString:
+        *len = val->length;
+        return val->u.sval;
+    case CMJsonValueLong:
+        *len = (size_t)snprintf(buf, bufsz, "%lld", (long long)val->u.lval);
+        return buf;
+    case CMJsonValueDouble:
+        *len = (size_t)snprintf(buf, bufsz, "%g", val->u.dval);
+        return buf;
+    case CMJsonValueBoolean:
+        *len = (size_t)snprintf(buf, bufsz, "%s",
+                                val->u.bval? "true":"false");
+        return buf;
+    default:
+        *len = 0;
+        return NULL;
+    }
+}
+
+CMBool CMDBM_StructBinderFill(CMDBM_StructBinder *binder, void *item)
+{
+    uint32_t i;
+    for (i=0; i<binder->count; i++) {
+        CMDBM_ColumnValue val;
+        const CMDBM_StructField *field = binder->bindings[i].field;
+        char *target = (char*)item + field->offset;
+        char nbuf[64];
+        const char *sval = NULL;
+        size_t slen = 0;
+        if (!CMCall(binder->cursor, GetValue, binder->bindings[i].col, &val)) {
+            CMLogErrorS("cannot read column for field %s.", field->name);
+            return CMFalse;
+        }
+        if (val.type == CMJsonValueNull) {
+            memset(target, 0x0, field->size);
+            continue;
+        }
+        switch (field->type) {
+        case CMDBM_FieldInt:
+            *((int32_t*)target) = (int32_t)CMDBM_ValueToLong(&val);
+            break;
+        case CMDBM_FieldLong:
+            *((int64_t*)target) = CMDBM_ValueToLong(&val);
+            break;
+        case CMDBM_FieldDouble:
+            *((double*)target) = CMDBM_ValueToDouble(&val);
+            break;
+        case CMDBM_FieldBoolean:
+            *((CMBool*)target) = CMDBM_ValueToBoolean(&val);
+            break;
+        case CMDBM_FieldString:
+            sval = CMDBM_StructBinderString(&val, nbuf, sizeof(nbuf), &slen);
+            if (field->size == 0)
+                break;
+            if (slen >= field->size)
+                slen = field->size - 1;
+            memcpy(target, sval, slen);
+            target[slen] = 0x0;
+            break;
+        case CMDBM_FieldStringPtr:
+            sval = CMDBM_StructBinderString(&val, nbuf, sizeof(nbuf), &slen);
+            *((char**)target) = CMAlloc(slen + 1);
+            memcpy(*((char**)target), sval, slen);
+            (*((char**)target))[slen] = 0x0;
+            break;
+        }
+    }
+    return CMTrue;
+}
+
+void CMDBM_StructBinderClearItem(CMDBM_StructBinder *binder, void *item)
+{
+    uint32_t i;
+    for (i=0; i<binder->count; i++) {
+        const CMDBM_StructField *field = binder->bindings[i].field;
+        if (field->type == CMDBM_FieldStringPtr) {
+            char **target = (char**)((char*)item + field->offset);
+            if (*target) CMFree(*target);
+            *target = NULL;
+        }
+    }
+}
+
+size_t CMDBM_StructBinderGetSize(CMDBM_StructBinder *binder)
+{
+    return binder->stype->size;
+}
+
+void CMDBM_StructBinderDestroy(CMDBM_StructBinder *binder)
+{
+    if (binder) {
+        if (binder->bindings) CMFree(binder->bindings);
+        CMFree(binder);
+    }
+}
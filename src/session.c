@@ -8,26 +8,82 @@ typedef struct CMDBM_Session_Internal {
     CMUTIL_Map      *conns;
     CMDBM_ContextEx *ctx;
     CMBool          istrans;
-    int             dummy_padder;
+    CMBool          rowreuse;
+    uint32_t        prefetch;
+    CMBool          parallel;   // rows are given to worker threads
+    CMDBM_LobSource *lobs;      // sources of statement being built
+    uint32_t        lobcnt;
+    uint32_t        lobslotcnt;
+    CMDBM_LobSource **lobslots; // lob source by bind index
+    size_t          lobslotcap;
+    long            cotimeout;  // negative for database default
 } CMDBM_Session_Internal;
 
+typedef struct CMDBM_SessionConn {
+    CMDBM_Connection    *conn;
+    uint32_t            refcnt;     // statements running on this connection
+    CMBool              intrans;    // joined to session transaction
+    CMBool              prefetch;   // driven by prefetch thread, no sharing
+} CMDBM_SessionConn;
+
 #define CMDBM_SessionTrans(isess, method) do {\
     if (CMCall(isess->conns, GetSize) > 0) {\
         CMUTIL_Iterator *iter = CMCall(isess->conns, Iterator);\
         while (CMCall(iter, HasNext)) {\
-            CMDBM_Connection *conn =\
-                    (CMDBM_Connection*)CMCall(iter, Next);\
-            CMCall(conn, method);\
+            CMDBM_SessionConn *sconn =\
+                    (CMDBM_SessionConn*)CMCall(iter, Next);\
+            CMCall(sconn->conn, method);\
+        }\
+        CMCall(iter, Destroy);\
+    }\
+} while(0)
+
+// applies 'method' to connections which joined session transaction.
+#define CMDBM_SessionTransJoined(isess, method) do {\
+    if (CMCall(isess->conns, GetSize) > 0) {\
+        CMUTIL_Iterator *iter = CMCall(isess->conns, Iterator);\
+        while (CMCall(iter, HasNext)) {\
+            CMDBM_SessionConn *sconn =\
+                    (CMDBM_SessionConn*)CMCall(iter, Next);\
+            if (sconn->intrans)\
+                CMCall(sconn->conn, method);\
         }\
         CMCall(iter, Destroy);\
     }\
 } while(0)
 
+// transaction calls are refused while a prefetch thread drives a connection
+// or worker threads of parallel iteration may call them concurrently.
+CMDBM_STATIC CMBool CMDBM_SessionPrefetching(CMDBM_Session_Internal *isess)
+{
+    CMBool res = CMFalse;
+    if (isess->parallel) {
+        CMLogErrorS("transaction cannot end inside parallel ForEachRow.");
+        return CMTrue;
+    }
+    if (CMCall(isess->conns, GetSize) > 0) {
+        CMUTIL_Iterator *iter = CMCall(isess->conns, Iterator);
+        while (!res && CMCall(iter, HasNext)) {
+            CMDBM_SessionConn *sconn =
+                    (CMDBM_SessionConn*)CMCall(iter, Next);
+            res = sconn->prefetch;
+        }
+        CMCall(iter, Destroy);
+    }
+    if (res)
+        CMLogErrorS("transaction cannot end inside prefetched ForEachRow.");
+    return res;
+}
+
 CMDBM_STATIC CMBool CMDBM_SessionBeginTransaction(CMDBM_Session *sess)
 {
     CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    if (isess->parallel) {
+        CMLogErrorS("transaction cannot begin inside parallel ForEachRow.");
+        return CMFalse;
+    }
     if (!isess->istrans) {
-        CMDBM_SessionTrans(isess, BeginTransaction);
+        // connections join when they run their first statement.
         isess->istrans = CMTrue;
     } else {
         CMLogWarnS("transaction started already.");
@@ -35,12 +91,34 @@ CMDBM_STATIC CMBool CMDBM_SessionBeginTransaction(CMDBM_Session *sess)
     return isess->istrans;
 }
 
+// returns connections which are not used by any statement to the pool.
+CMDBM_STATIC void CMDBM_SessionReleaseIdle(CMDBM_Session_Internal *isess)
+{
+    uint32_t i;
+    CMUTIL_StringArray *keys = CMCall(isess->conns, GetKeys);
+    for (i=0; i<CMCall(keys, GetSize); i++) {
+        const char *dbid = CMCall(keys, GetCString, i);
+        CMDBM_SessionConn *sconn =
+                (CMDBM_SessionConn*)CMCall(isess->conns, Get, dbid);
+        sconn->intrans = CMFalse;
+        if (sconn->refcnt == 0) {
+            CMCall(isess->conns, Remove, dbid);
+            CMCall(sconn->conn, Close);
+            CMFree(sconn);
+        }
+    }
+    CMCall(keys, Destroy);
+}
+
 CMDBM_STATIC void CMDBM_SessionEndTransaction(CMDBM_Session *sess)
 {
     CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    if (CMDBM_SessionPrefetching(isess))
+        return;
     if (isess->istrans) {
-        CMDBM_SessionTrans(isess, EndTransaction);
+        CMDBM_SessionTransJoined(isess, EndTransaction);
         isess->istrans = CMFalse;
+        CMDBM_SessionReleaseIdle(isess);
     } else {
         CMLogWarnS("transaction not started.");
     }
@@ -49,8 +127,10 @@ CMDBM_STATIC void CMDBM_SessionEndTransaction(CMDBM_Session *sess)
 CMDBM_STATIC CMBool CMDBM_SessionCommit(CMDBM_Session *sess)
 {
     CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    if (CMDBM_SessionPrefetching(isess))
+        return CMFalse;
     if (isess->istrans) {
-        CMDBM_SessionTrans(isess, Commit);
+        CMDBM_SessionTransJoined(isess, Commit);
         return CMTrue;
     } else {
         CMLogWarnS("transaction not started.");
@@ -61,8 +141,10 @@ CMDBM_STATIC CMBool CMDBM_SessionCommit(CMDBM_Session *sess)
 CMDBM_STATIC void CMDBM_SessionRollback(CMDBM_Session *sess)
 {
     CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    if (CMDBM_SessionPrefetching(isess))
+        return;
     if (isess->istrans) {
-        CMDBM_SessionTrans(isess, Rollback);
+        CMDBM_SessionTransJoined(isess, Rollback);
     } else {
         CMLogWarnS("transaction not started.");
     }
@@ -74,25 +156,84 @@ CMDBM_STATIC void CMDBM_SessionClose(CMDBM_Session *sess)
     if (isess) {
         CMDBM_SessionTrans(isess, Close);
         CMCall(isess->conns, Destroy);
+        if (isess->lobslots) CMFree(isess->lobslots);
         CMFree(isess);
     }
 }
 
+/*
+ * Checks out connection of 'dbid' for one statement. Nested statements
+ * share it, and every call must be paired with ReleaseConnection.
+ */
 CMDBM_STATIC CMDBM_Connection *CMDBM_SessionGetConnection(
         CMDBM_Session_Internal *isess, const char *dbid)
 {
-    CMDBM_Connection *conn = CMCall(isess->conns, Get, dbid);
-    if (conn == NULL) {
+    CMDBM_SessionConn *sconn = NULL;
+    // connection map is not shared with worker threads.
+    if (isess->parallel) {
+        CMLogErrorS("session is used by parallel ForEachRow, "
+                    "statement on source '%s' rejected.", dbid);
+        return NULL;
+    }
+    sconn = (CMDBM_SessionConn*)CMCall(isess->conns, Get, dbid);
+    if (sconn == NULL) {
         CMDBM_DatabaseEx *db = CMCall(isess->ctx, GetDatabase, dbid);
-        if (db) {
-            conn = CMCall(db, GetConnection);
-            if (conn)
-                CMCall(isess->conns, Put, dbid, conn, NULL);
-            else
-                CMLogErrorS("cannot get connection from source '%s'", dbid);
+        CMDBM_Connection *conn = NULL;
+        if (db == NULL)
+            return NULL;
+        conn = CMCall(db, GetConnection, isess->cotimeout);
+        if (conn == NULL) {
+            CMLogErrorS("cannot get connection from source '%s'", dbid);
+            return NULL;
+        }
+        sconn = CMAlloc(sizeof(CMDBM_SessionConn));
+        memset(sconn, 0x0, sizeof(CMDBM_SessionConn));
+        sconn->conn = conn;
+        CMCall(isess->conns, Put, dbid, sconn, NULL);
+    } else if (sconn->prefetch) {
+        CMLogErrorS("connection of source '%s' is used by prefetch, "
+                    "statement from row callback rejected.", dbid);
+        return NULL;
+    }
+    // transaction is started by the first statement on each connection.
+    if (isess->istrans && !sconn->intrans) {
+        if (!CMCall(sconn->conn, BeginTransaction)) {
+            CMLogErrorS("cannot start transaction on source '%s'", dbid);
+            if (sconn->refcnt == 0) {
+                CMCall(isess->conns, Remove, dbid);
+                CMCall(sconn->conn, EndTransaction);
+                CMCall(sconn->conn, Close);
+                CMFree(sconn);
+            }
+            return NULL;
         }
+        sconn->intrans = CMTrue;
+    }
+    sconn->refcnt++;
+    return sconn->conn;
+}
+
+/*
+ * Returns connection to the pool when the last statement using it ends.
+ * Connections stay pinned to the session while transaction is active.
+ */
+CMDBM_STATIC void CMDBM_SessionReleaseConnection(
+        CMDBM_Session_Internal *isess, const char *dbid,
+        CMDBM_Connection *conn)
+{
+    CMDBM_SessionConn *sconn = NULL;
+    if (conn == NULL)
+        return;
+    sconn = (CMDBM_SessionConn*)CMCall(isess->conns, Get, dbid);
+    if (sconn == NULL || sconn->conn != conn)
+        return;
+    if (sconn->refcnt > 0)
+        sconn->refcnt--;
+    if (sconn->refcnt == 0 && !isess->istrans) {
+        CMCall(isess->conns, Remove, dbid);
+        CMCall(conn, Close);
+        CMFree(sconn);
     }
-    return conn;
 }
 
 CMDBM_STATIC CMUTIL_String *CMDBM_SessionGetQuery(
@@ -105,6 +246,8 @@ CMDBM_STATIC CMUTIL_String *CMDBM_SessionGetQuery(
     CMDBM_Connection *conn = NULL;
     CMUTIL_String *query = NULL;
     CMUTIL_XmlNode *xqry = NULL;
+    CMUTIL_String *fetchattr = NULL;
+    uint32_t fetchsize = 0;
     CMBool succ = CMFalse;
     if (!db) {
         CMLogErrorS("unknown datasource id: %s.", dbid);
@@ -124,6 +267,15 @@ CMDBM_STATIC CMUTIL_String *CMDBM_SessionGetQuery(
     conn = CMDBM_SessionGetConnection(isess, dbid);
     if (!conn) goto ENDPOINT;
 
+    // zero means module default.
+    fetchattr = CMCall(xqry, GetAttribute, "fetchSize");
+    if (fetchattr)
+        fetchsize = (uint32_t)strtoul(
+                    CMCall(fetchattr, GetCString), NULL, 10);
+    else
+        fetchsize = CMCall(db, GetFetchSize);
+    CMCall(conn, SetFetchSize, fetchsize);
+
     CMCall(db, LockQueryItem);
     succ = CMDBM_BuildNode(sess, conn, xqry, params, *binds, *after,
                            query, *outs, *rembuf);
@@ -142,6 +294,8 @@ ENDPOINT:
         *binds = NULL;
         query = NULL;
     }
+    // caller holds its own reference for the statement.
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
     CMLogDebug("%s.%s - %s", dbid, sqlid, CMCall(query, GetCString));
     return query;
 }
@@ -169,6 +323,7 @@ CMDBM_STATIC CMBool CMDBM_SessionExecAfters(
     } else {
         CMLogError("cannot get connection from source: %s", dbid);
     }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
     CMCall(dummy, Destroy);
     return res;
 }
@@ -204,6 +359,7 @@ CMDBM_STATIC void CMDBM_SessionCleanUp(
     CMUTIL_JsonArray *binds = NULL;\
     CMUTIL_List *after = NULL, *rembuf = NULL;\
     CMUTIL_String *query = NULL;\
+    if (!conn) return res;\
     query = CMDBM_SessionGetQuery(\
                     sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);\
     if (query) {\
@@ -221,6 +377,7 @@ CMDBM_STATIC void CMDBM_SessionCleanUp(
         }\
         CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);\
     }\
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);\
     return res;\
 } while(0)
 
@@ -241,6 +398,75 @@ CMDBM_STATIC int CMDBM_SessionExecute(
     CMDBM_SessionRun(int, -1, Execute, CMDBM_SessionItemDestroyerDummy);
 }
 
+CMBool CMDBM_SessionBindLob(
+        CMDBM_Session *sess, const char *key, uint32_t index)
+{
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    uint32_t i;
+    for (i=0; i<isess->lobcnt; i++) {
+        if (strcmp(isess->lobs[i].name, key) == 0) {
+            size_t keep = sizeof(CMDBM_LobSource*) * isess->lobslotcnt;
+            isess->lobslots = (CMDBM_LobSource**)CMDBM_BufferGrow(
+                        isess->lobslots, &isess->lobslotcap,
+                        sizeof(CMDBM_LobSource*) * (index + 1), keep);
+            while (isess->lobslotcnt <= index)
+                isess->lobslots[isess->lobslotcnt++] = NULL;
+            isess->lobslots[index] = &(isess->lobs[i]);
+            return CMTrue;
+        }
+    }
+    return CMFalse;
+}
+
+CMDBM_STATIC int CMDBM_SessionExecuteLob(
+        CMDBM_Session *sess, const char *dbid, const char *sqlid,
+        CMUTIL_JsonObject *params, CMDBM_LobSource *lobs, uint32_t lobcnt)
+{
+    int res = -1;
+    uint32_t i;
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    CMDBM_Connection *conn = CMDBM_SessionGetConnection(isess, dbid);
+    CMUTIL_JsonObject *outs = NULL;
+    CMUTIL_JsonArray *binds = NULL;
+    CMUTIL_List *after = NULL, *rembuf = NULL;
+    CMUTIL_String *query = NULL;
+    CMDBM_LobSource **aligned = NULL;
+
+    if (!conn) return res;
+    // streamed parameters need only a placeholder value.
+    for (i=0; i<lobcnt; i++)
+        if (!CMCall(params, Get, lobs[i].name))
+            CMCall(params, PutNull, lobs[i].name);
+    isess->lobs = lobs;
+    isess->lobcnt = lobcnt;
+    isess->lobslotcnt = 0;
+    query = CMDBM_SessionGetQuery(
+                sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);
+    isess->lobs = NULL;
+    isess->lobcnt = 0;
+    if (query) {
+        size_t bsize = CMCall(binds, GetSize);
+        aligned = CMAlloc(sizeof(CMDBM_LobSource*) * (bsize + 1));
+        for (i=0; i<bsize; i++)
+            aligned[i] = i < isess->lobslotcnt? isess->lobslots[i]:NULL;
+        res = CMCall(conn, ExecuteLob, query, binds, outs, aligned);
+        if (res >= 0) {
+            if (!CMDBM_SessionExecAfters(sess, dbid, params, after, rembuf)) {
+                CMLogErrorS("selectKey part of %s.%s execution failed.",
+                            dbid, sqlid);
+                res = -1;
+            }
+        } else {
+            CMLogErrorS("%s.%s query execution failed. -> %s",
+                        dbid, sqlid, CMCall(query, GetCString));
+        }
+        CMFree(aligned);
+        CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);
+    }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
+    return res;
+}
+
 CMDBM_STATIC CMUTIL_JsonValue *CMDBM_SessionGetObject(
         CMDBM_Session *sess, const char *dbid,
         const char *sqlid, CMUTIL_JsonObject *params)
@@ -271,7 +497,9 @@ CMDBM_STATIC CMUTIL_JsonArray *CMDBM_SessionGetRowSet(
     CMUTIL_JsonObject *outs = NULL;
     CMUTIL_JsonArray *binds = NULL;
     CMUTIL_List *after = NULL, *rembuf = NULL;
-    CMUTIL_String *query = CMDBM_SessionGetQuery(
+    CMUTIL_String *query = NULL;
+    if (!conn) return res;
+    query = CMDBM_SessionGetQuery(
                 sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);
     if (query) {
         res = conn->GetList(conn, query, binds, outs);
@@ -288,6 +516,53 @@ CMDBM_STATIC CMUTIL_JsonArray *CMDBM_SessionGetRowSet(
         }
         CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);
     }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
+    return res;
+}
+
+CMDBM_STATIC CMBool CMDBM_SessionRefillRow(
+        CMDBM_Cursor *csr, CMUTIL_JsonObject *row, uint32_t colcnt)
+{
+    uint32_t i;
+    for (i=0; i<colcnt; i++) {
+        CMDBM_ColumnValue val;
+        CMUTIL_JsonValue *jval = NULL;
+        const char *name = CMCall(csr, GetColumnName, i);
+        if (!CMCall(csr, GetValue, i, &val))
+            return CMFalse;
+        jval = (CMUTIL_JsonValue*)CMCall(row, Get, name);
+        // callback may have replaced or removed the item.
+        if (jval == NULL ||
+                CMCall((CMUTIL_Json*)jval, GetType) != CMJsonTypeValue) {
+            CMCall(row, PutNull, name);
+            jval = (CMUTIL_JsonValue*)CMCall(row, Get, name);
+        }
+        switch (val.type) {
+        case CMJsonValueLong:    CMCall(jval, SetLong, val.u.lval); break;
+        case CMJsonValueDouble:  CMCall(jval, SetDouble, val.u.dval); break;
+        case CMJsonValueBoolean: CMCall(jval, SetBoolean, val.u.bval); break;
+        case CMJsonValueString:  CMCall(jval, SetString, val.u.sval); break;
+        default:                 CMCall(jval, SetNull); break;
+        }
+    }
+    return CMTrue;
+}
+
+/*
+ * Runs prefetched iteration with connection pinned, so statements and
+ * transaction calls from row callback do not drive it concurrently.
+ */
+CMDBM_STATIC CMBool CMDBM_SessionPrefetch(
+        CMDBM_Session_Internal *isess, const char *dbid,
+        CMDBM_Connection *conn, CMDBM_Cursor *csr, void *udata,
+        CMBool (*rowcb)(CMUTIL_JsonObject*, uint32_t, void*))
+{
+    CMBool res = CMFalse;
+    CMDBM_SessionConn *sconn =
+            (CMDBM_SessionConn*)CMCall(isess->conns, Get, dbid);
+    sconn->prefetch = CMTrue;
+    res = CMDBM_PrefetchForEach(conn, csr, isess->prefetch, udata, rowcb);
+    sconn->prefetch = CMFalse;
     return res;
 }
 
@@ -302,7 +577,9 @@ CMDBM_STATIC CMBool CMDBM_SessionForEachRow(
     CMUTIL_JsonObject *outs = NULL;
     CMUTIL_JsonArray *binds = NULL;
     CMUTIL_List *after = NULL, *rembuf = NULL;
-    CMUTIL_String *query = CMDBM_SessionGetQuery(
+    CMUTIL_String *query = NULL;
+    if (!conn) return res;
+    query = CMDBM_SessionGetQuery(
                 sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);
     if (query) {
         CMDBM_Cursor *csr = conn->OpenCursor(conn, query, binds, outs);
@@ -314,18 +591,448 @@ CMDBM_STATIC CMBool CMDBM_SessionForEachRow(
                 uint32_t idx = 0;
                 CMUTIL_JsonObject *row = NULL;
                 CMBool cont = CMTrue;
-                while (cont && ((row = CMCall(csr, GetNext)) != NULL)) {
-                    cont = rowcb(row, idx++, udata);
+                res = CMTrue;
+                if (isess->prefetch > 0 &&
+                        CMDBM_SessionPrefetch(isess, dbid, conn, csr,
+                                              udata, rowcb)) {
+                    // rows are fetched by prefetch thread.
+                } else if (isess->rowreuse) {
+                    // one row object is refilled in place for every row.
+                    uint32_t colcnt = CMCall(csr, GetColumnCount);
+                    row = CMUTIL_JsonObjectCreate();
+                    while (cont && CMCall(csr, Fetch)) {
+                        if (!CMDBM_SessionRefillRow(csr, row, colcnt)) {
+                            CMLogErrorS("%s.%s cannot read row %u.",
+                                        dbid, sqlid, idx);
+                            res = CMFalse;
+                            break;
+                        }
+                        cont = rowcb(row, idx++, udata);
+                    }
                     CMUTIL_JsonDestroy(row);
+                } else {
+                    while (cont && ((row = CMCall(csr, GetNext)) != NULL)) {
+                        cont = rowcb(row, idx++, udata);
+                        CMUTIL_JsonDestroy(row);
+                    }
+                }
+                if (res && CMCall(csr, HasFailed)) {
+                    CMLogErrorS("%s.%s fetching rows failed.", dbid, sqlid);
+                    res = CMFalse;
                 }
+            }
+            CMCall(csr, Close);
+        } else {
+            CMLogErrorS("%s.%s query execution failed. -> %s",
+                        dbid, sqlid, CMCall(query, GetCString));
+        }
+        CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);
+    }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
+    return res;
+}
+
+CMDBM_STATIC CMBool CMDBM_SessionForEachRowParallel(
+        CMDBM_Session *sess, const char *dbid, const char *sqlid,
+        CMUTIL_JsonObject *params, uint32_t nthreads, CMBool ordered,
+        void *udata,
+        CMBool (*rowcb)(CMUTIL_JsonObject*, uint32_t, void*),
+        CMBool (*commitcb)(CMUTIL_JsonObject*, uint32_t, void*))
+{
+    CMBool res = CMFalse;
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    CMDBM_Connection *conn = CMDBM_SessionGetConnection(isess, dbid);
+    CMUTIL_JsonObject *outs = NULL;
+    CMUTIL_JsonArray *binds = NULL;
+    CMUTIL_List *after = NULL, *rembuf = NULL;
+    CMUTIL_String *query = NULL;
+    if (!conn) return res;
+    query = CMDBM_SessionGetQuery(
+                sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);
+    if (query) {
+        CMDBM_Cursor *csr = conn->OpenCursor(conn, query, binds, outs);
+        if (csr != NULL) {
+            if (!CMDBM_SessionExecAfters(sess, dbid, params, after, rembuf)) {
+                CMLogErrorS("selectKey part of %s.%s execution failed.",
+                            dbid, sqlid);
+            } else {
+                // callbacks must not use this session until workers end.
+                isess->parallel = CMTrue;
+                res = CMDBM_ParallelForEach(
+                            csr, nthreads, ordered, udata, rowcb, commitcb);
+                isess->parallel = CMFalse;
+                if (res && CMCall(csr, HasFailed))
+                    res = CMFalse;
+                if (!res)
+                    CMLogErrorS("%s.%s parallel iteration failed.",
+                                dbid, sqlid);
+            }
+            CMCall(csr, Close);
+        } else {
+            CMLogErrorS("%s.%s query execution failed. -> %s",
+                        dbid, sqlid, CMCall(query, GetCString));
+        }
+        CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);
+    }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
+    return res;
+}
+
+CMDBM_STATIC int CMDBM_SessionCopyIn(
+        CMDBM_Session *sess, const char *dbid, const char *table,
+        CMUTIL_StringArray *columns, CMUTIL_JsonArray *rows, void *udata,
+        CMBool (*rowcb)(CMDBM_CopyRow*, uint32_t, void*))
+{
+    int res = -1;
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    CMDBM_Connection *conn = NULL;
+    if (!rows && !rowcb) {
+        CMLogErrorS("neither rows nor row callback given for %s.%s.",
+                    dbid, table);
+        return res;
+    }
+    conn = CMDBM_SessionGetConnection(isess, dbid);
+    if (conn) {
+        res = CMCall(conn, CopyIn, table, columns, rows, udata, rowcb);
+        if (res < 0)
+            CMLogErrorS("bulk load into %s.%s failed.", dbid, table);
+    }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
+    return res;
+}
+
+CMDBM_STATIC int CMDBM_SessionCopyOut(
+        CMDBM_Session *sess, const char *dbid, const char *sqlid,
+        CMUTIL_JsonObject *params, CMDBM_CopyFormat format, void *udata,
+        CMBool (*sink)(const char*, size_t, void*))
+{
+    int res = -1;
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    CMDBM_Connection *conn = CMDBM_SessionGetConnection(isess, dbid);
+    CMUTIL_JsonObject *outs = NULL;
+    CMUTIL_JsonArray *binds = NULL;
+    CMUTIL_List *after = NULL, *rembuf = NULL;
+    CMUTIL_String *query = NULL;
+    if (!conn) return res;
+    query = CMDBM_SessionGetQuery(
+                sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);
+    if (query) {
+        res = CMCall(conn, CopyOut, query, binds, format, udata, sink);
+        if (res < 0)
+            CMLogErrorS("%s.%s bulk export failed. -> %s",
+                        dbid, sqlid, CMCall(query, GetCString));
+        CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);
+    }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
+    return res;
+}
+
+CMDBM_STATIC CMDBM_ResultSet *CMDBM_SessionGetResultSet(
+        CMDBM_Session *sess, const char *dbid,
+        const char *sqlid, CMUTIL_JsonObject *params)
+{
+    CMDBM_ResultSet *res = NULL;
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    CMDBM_Connection *conn = CMDBM_SessionGetConnection(isess, dbid);
+    CMUTIL_JsonObject *outs = NULL;
+    CMUTIL_JsonArray *binds = NULL;
+    CMUTIL_List *after = NULL, *rembuf = NULL;
+    CMUTIL_String *query = NULL;
+    if (!conn) return res;
+    query = CMDBM_SessionGetQuery(
+                sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);
+    if (query) {
+        CMDBM_Cursor *csr = conn->OpenCursor(conn, query, binds, outs);
+        if (csr != NULL) {
+            if (!CMDBM_SessionExecAfters(sess, dbid, params, after, rembuf)) {
+                CMLogErrorS("selectKey part of %s.%s execution failed.",
+                            dbid, sqlid);
+            } else {
+                CMDBM_DatabaseEx *db = CMCall(isess->ctx, GetDatabase, dbid);
+                res = CMDBM_ResultSetCreate(csr, CMCall(db, GetResultMemory));
+                if (res == NULL)
+                    CMLogErrorS("%s.%s cannot build result set.",
+                                dbid, sqlid);
+            }
+            CMCall(csr, Close);
+        } else {
+            CMLogErrorS("%s.%s query execution failed. -> %s",
+                        dbid, sqlid, CMCall(query, GetCString));
+        }
+        CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);
+    }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
+    return res;
+}
+
+CMDBM_STATIC CMBool CMDBM_SessionForEachRowTyped(
+        CMDBM_Session *sess, const char *dbid, const char *sqlid,
+        CMUTIL_JsonObject *params, void *udata,
+        CMBool (*rowcb)(const CMDBM_Row*, uint32_t, void*))
+{
+    CMBool res = CMFalse;
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    CMDBM_Connection *conn = CMDBM_SessionGetConnection(isess, dbid);
+    CMUTIL_JsonObject *outs = NULL;
+    CMUTIL_JsonArray *binds = NULL;
+    CMUTIL_List *after = NULL, *rembuf = NULL;
+    CMUTIL_String *query = NULL;
+    if (!conn) return res;
+    query = CMDBM_SessionGetQuery(
+                sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);
+    if (query) {
+        CMDBM_Cursor *csr = conn->OpenCursor(conn, query, binds, outs);
+        if (csr != NULL) {
+            if (!CMDBM_SessionExecAfters(sess, dbid, params, after, rembuf)) {
+                CMLogErrorS("selectKey part of %s.%s execution failed.",
+                            dbid, sqlid);
+            } else {
+                uint32_t idx = 0;
+                CMBool cont = CMTrue;
+                CMDBM_Row *row = CMDBM_RowCreate(csr);
+                while (cont && CMCall(csr, Fetch))
+                    cont = rowcb(row, idx++, udata);
+                CMDBM_RowDestroy(row);
                 res = CMTrue;
+                if (CMCall(csr, HasFailed)) {
+                    CMLogErrorS("%s.%s fetching rows failed.", dbid, sqlid);
+                    res = CMFalse;
+                }
+            }
+            CMCall(csr, Close);
+        } else {
+            CMLogErrorS("%s.%s query execution failed. -> %s",
+                        dbid, sqlid, CMCall(query, GetCString));
+        }
+        CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);
+    }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
+    return res;
+}
+
+CMDBM_STATIC int CMDBM_SessionGetStructList(
+        CMDBM_Session *sess, const char *dbid, const char *sqlid,
+        CMUTIL_JsonObject *params, void *rows, uint32_t maxrows)
+{
+    int res = -1;
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    CMDBM_Connection *conn = CMDBM_SessionGetConnection(isess, dbid);
+    CMUTIL_JsonObject *outs = NULL;
+    CMUTIL_JsonArray *binds = NULL;
+    CMUTIL_List *after = NULL, *rembuf = NULL;
+    CMUTIL_String *query = NULL;
+    if (!conn) return res;
+    query = CMDBM_SessionGetQuery(
+                sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);
+    if (query) {
+        CMDBM_Cursor *csr = conn->OpenCursor(conn, query, binds, outs);
+        if (csr != NULL) {
+            if (!CMDBM_SessionExecAfters(sess, dbid, params, after, rembuf)) {
+                CMLogErrorS("selectKey part of %s.%s execution failed.",
+                            dbid, sqlid);
+            } else {
+                CMDBM_StructBinder *binder = CMDBM_StructBinderCreate(
+                            csr, CMCall(isess->ctx, GetDatabase, dbid), sqlid);
+                if (binder) {
+                    size_t size = CMDBM_StructBinderGetSize(binder);
+                    uint32_t cnt = 0;
+                    CMBool succ = CMTrue;
+                    while (succ && cnt < maxrows && CMCall(csr, Fetch)) {
+                        void *item = (char*)rows + size * cnt;
+                        memset(item, 0x0, size);
+                        succ = CMDBM_StructBinderFill(binder, item);
+                        cnt++;
+                    }
+                    if (succ && CMCall(csr, HasFailed)) {
+                        CMLogErrorS("%s.%s fetching rows failed.", dbid, sqlid);
+                        succ = CMFalse;
+                    }
+                    if (succ) {
+                        res = (int)cnt;
+                    } else {
+                        // caller does not get failed rows, release them.
+                        while (cnt > 0) {
+                            cnt--;
+                            CMDBM_StructBinderClearItem(
+                                        binder, (char*)rows + size * cnt);
+                        }
+                    }
+                    CMDBM_StructBinderDestroy(binder);
+                }
+            }
+            CMCall(csr, Close);
+        } else {
+            CMLogErrorS("%s.%s query execution failed. -> %s",
+                        dbid, sqlid, CMCall(query, GetCString));
+        }
+        CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);
+    }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
+    return res;
+}
+
+CMDBM_STATIC CMBool CMDBM_SessionForEachStruct(
+        CMDBM_Session *sess, const char *dbid, const char *sqlid,
+        CMUTIL_JsonObject *params, void *udata,
+        CMBool (*rowcb)(void*, uint32_t, void*))
+{
+    CMBool res = CMFalse;
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    CMDBM_Connection *conn = CMDBM_SessionGetConnection(isess, dbid);
+    CMUTIL_JsonObject *outs = NULL;
+    CMUTIL_JsonArray *binds = NULL;
+    CMUTIL_List *after = NULL, *rembuf = NULL;
+    CMUTIL_String *query = NULL;
+    if (!conn) return res;
+    query = CMDBM_SessionGetQuery(
+                sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);
+    if (query) {
+        CMDBM_Cursor *csr = conn->OpenCursor(conn, query, binds, outs);
+        if (csr != NULL) {
+            if (!CMDBM_SessionExecAfters(sess, dbid, params, after, rembuf)) {
+                CMLogErrorS("selectKey part of %s.%s execution failed.",
+                            dbid, sqlid);
+            } else {
+                CMDBM_StructBinder *binder = CMDBM_StructBinderCreate(
+                            csr, CMCall(isess->ctx, GetDatabase, dbid), sqlid);
+                if (binder) {
+                    size_t size = CMDBM_StructBinderGetSize(binder);
+                    void *item = CMAlloc(size);
+                    uint32_t idx = 0;
+                    CMBool cont = CMTrue;
+                    res = CMTrue;
+                    while (cont && CMCall(csr, Fetch)) {
+                        memset(item, 0x0, size);
+                        if (!CMDBM_StructBinderFill(binder, item)) {
+                            CMDBM_StructBinderClearItem(binder, item);
+                            res = CMFalse;
+                            break;
+                        }
+                        cont = rowcb(item, idx++, udata);
+                        CMDBM_StructBinderClearItem(binder, item);
+                    }
+                    if (res && CMCall(csr, HasFailed)) {
+                        CMLogErrorS("%s.%s fetching rows failed.", dbid, sqlid);
+                        res = CMFalse;
+                    }
+                    CMFree(item);
+                    CMDBM_StructBinderDestroy(binder);
+                }
+            }
+            CMCall(csr, Close);
+        } else {
+            CMLogErrorS("%s.%s query execution failed. -> %s",
+                        dbid, sqlid, CMCall(query, GetCString));
+        }
+        CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);
+    }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
+    return res;
+}
+
+CMDBM_STATIC void CMDBM_SessionSetRowReuse(
+        CMDBM_Session *sess, CMBool reuse)
+{
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    isess->rowreuse = reuse;
+}
+
+CMDBM_STATIC void CMDBM_SessionSetPrefetch(
+        CMDBM_Session *sess, uint32_t batchrows)
+{
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    isess->prefetch = batchrows;
+}
+
+CMDBM_STATIC void CMDBM_SessionSetCheckoutTimeout(
+        CMDBM_Session *sess, long millisec)
+{
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    isess->cotimeout = millisec;
+}
+
+CMDBM_STATIC int CMDBM_SessionExportRows(
+        CMDBM_Session *sess, const char *dbid, const char *sqlid,
+        CMUTIL_JsonObject *params, CMDBM_ExportFormat format, void *udata,
+        CMBool (*sink)(const char*, size_t, void*))
+{
+    int res = -1;
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    CMDBM_Connection *conn = NULL;
+    CMUTIL_JsonObject *outs = NULL;
+    CMUTIL_JsonArray *binds = NULL;
+    CMUTIL_List *after = NULL, *rembuf = NULL;
+    CMUTIL_String *query = NULL;
+    if (!sink) {
+        CMLogErrorS("no sink given for export of %s.%s.", dbid, sqlid);
+        return res;
+    }
+    conn = CMDBM_SessionGetConnection(isess, dbid);
+    if (!conn) return res;
+    query = CMDBM_SessionGetQuery(
+                sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);
+    if (query) {
+        CMDBM_Cursor *csr = conn->OpenCursor(conn, query, binds, outs);
+        if (csr != NULL) {
+            if (!CMDBM_SessionExecAfters(sess, dbid, params, after, rembuf)) {
+                CMLogErrorS("selectKey part of %s.%s execution failed.",
+                            dbid, sqlid);
+            } else {
+                res = CMDBM_ExportCursor(csr, format, udata, sink);
+                if (res < 0)
+                    CMLogErrorS("%s.%s export failed.", dbid, sqlid);
+            }
+            CMCall(csr, Close);
+        } else {
+            CMLogErrorS("%s.%s query execution failed. -> %s",
+                        dbid, sqlid, CMCall(query, GetCString));
+        }
+        CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);
+    }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
+    return res;
+}
+
+CMDBM_STATIC int CMDBM_SessionGetColumnar(
+        CMDBM_Session *sess, const char *dbid, const char *sqlid,
+        CMUTIL_JsonObject *params, uint32_t batchrows, void *udata,
+        CMBool (*batchcb)(const struct ArrowSchema*,
+                          struct ArrowArray*, void*))
+{
+    int res = -1;
+    CMDBM_Session_Internal *isess = (CMDBM_Session_Internal*)sess;
+    CMDBM_Connection *conn = NULL;
+    CMUTIL_JsonObject *outs = NULL;
+    CMUTIL_JsonArray *binds = NULL;
+    CMUTIL_List *after = NULL, *rembuf = NULL;
+    CMUTIL_String *query = NULL;
+    if (!batchcb) {
+        CMLogErrorS("no batch callback given for %s.%s.", dbid, sqlid);
+        return res;
+    }
+    conn = CMDBM_SessionGetConnection(isess, dbid);
+    if (!conn) return res;
+    query = CMDBM_SessionGetQuery(
+                sess, dbid, sqlid, params, &binds, &outs, &after, &rembuf);
+    if (query) {
+        CMDBM_Cursor *csr = conn->OpenCursor(conn, query, binds, outs);
+        if (csr != NULL) {
+            if (!CMDBM_SessionExecAfters(sess, dbid, params, after, rembuf)) {
+                CMLogErrorS("selectKey part of %s.%s execution failed.",
+                            dbid, sqlid);
+            } else {
+                res = CMDBM_ColumnarCursor(csr, batchrows, udata, batchcb);
+                if (res < 0)
+                    CMLogErrorS("%s.%s columnar fetch failed.", dbid, sqlid);
             }
+            CMCall(csr, Close);
         } else {
             CMLogErrorS("%s.%s query execution failed. -> %s",
                         dbid, sqlid, CMCall(query, GetCString));
         }
         CMDBM_SessionCleanUp(isess, dbid, query, binds, outs, after, rembuf);
     }
+    CMDBM_SessionReleaseConnection(isess, dbid, conn);
     return res;
 }
 
@@ -339,7 +1046,20 @@ static CMDBM_Session g_cmdbm_session = {
     CMDBM_SessionForEachRow,
     CMDBM_SessionCommit,
     CMDBM_SessionRollback,
-    CMDBM_SessionClose
+    CMDBM_SessionClose,
+    CMDBM_SessionCopyIn,
+    CMDBM_SessionCopyOut,
+    CMDBM_SessionGetResultSet,
+    CMDBM_SessionForEachRowTyped,
+    CMDBM_SessionGetStructList,
+    CMDBM_SessionForEachStruct,
+    CMDBM_SessionSetRowReuse,
+    CMDBM_SessionExportRows,
+    CMDBM_SessionGetColumnar,
+    CMDBM_SessionSetPrefetch,
+    CMDBM_SessionForEachRowParallel,
+    CMDBM_SessionExecuteLob,
+    CMDBM_SessionSetCheckoutTimeout
 };
 
 CMDBM_Session *CMDBM_SessionCreate(CMDBM_ContextEx *ctx)
@@ -347,7 +1067,8 @@ CMDBM_Session *CMDBM_SessionCreate(CMDBM_ContextEx *ctx)
     CMDBM_Session_Internal *res = CMAlloc(sizeof(CMDBM_Session_Internal));
     memset(res, 0x0, sizeof(CMDBM_Session_Internal));
     memcpy(res, &g_cmdbm_session, sizeof(CMDBM_Session));
-    res->conns = CMUTIL_MapCreate();
+    res->conns = CMUTIL_MapCreateEx(16, CMFalse, CMFree, 0.75f);
     res->ctx = ctx;
+    res->cotimeout = -1;
     return (CMDBM_Session*)res;
 }
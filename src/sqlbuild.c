@@ -267,6 +267,9 @@ CMDBM_STATIC CMBool CMDBM_BuildBind(
         char buf[50];
         CMUTIL_JsonValue *value = (CMUTIL_JsonValue*)data;
         CMJsonValueType vtype = CMCall(value, GetValueType);
+        // streamed parameters are bound as strings.
+        if (CMDBM_SessionBindLob(sess, key, index))
+            vtype = CMJsonValueString;
         CMCall(conn, GetBindString, index, buf, vtype);
         CMCall(obuf, AddString, buf);
         CMCall(bindings, Add, data);
@@ -620,6 +623,8 @@ static CMDBM_BuildFunc g_cmdbm_buildfuncs[] = {
         ,CMDBM_BuildChildren    //nodeSqlOtherwise
         ,CMDBM_BuildIf            //nodeSqlIf
         ,CMDBM_BuildSelectKey    //nodeSqlSelectKey
+        ,NULL                    //nodeSqlResultMap
+        ,NULL                    //nodeSqlResult
 };
 
 CMBool CMDBM_BuildNode(
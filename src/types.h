@@ -5,10 +5,33 @@
 
 typedef struct CMDBM_DatabaseEx CMDBM_DatabaseEx;
 
+typedef struct CMDBM_StructType {
+    char                *name;
+    CMDBM_StructField   *fields;
+    size_t              size;
+    uint32_t            count;
+    int                 dummy_padder;
+} CMDBM_StructType;
+
 typedef struct CMDBM_Cursor CMDBM_Cursor;
 struct CMDBM_Cursor {
     CMUTIL_JsonObject *(*GetNext)(CMDBM_Cursor *cursor);
     void (*Close)(CMDBM_Cursor *cursor);
+    uint32_t (*GetColumnCount)(CMDBM_Cursor *cursor);
+    const char *(*GetColumnName)(CMDBM_Cursor *cursor, uint32_t index);
+    CMBool (*Fetch)(CMDBM_Cursor *cursor);
+    CMBool (*GetValue)(
+            CMDBM_Cursor *cursor,
+            uint32_t index,
+            CMDBM_ColumnValue *value);
+    CMJsonValueType (*GetColumnType)(CMDBM_Cursor *cursor, uint32_t index);
+    int64_t (*ReadLob)(
+            CMDBM_Cursor *cursor,
+            uint32_t index,
+            CMBool restart,
+            void *buf,
+            size_t size);
+    CMBool (*HasFailed)(CMDBM_Cursor *cursor);
 };
 
 typedef struct CMDBM_Connection CMDBM_Connection;
@@ -58,6 +81,35 @@ struct CMDBM_Connection {
             CMDBM_Connection *conn);
     void (*Rollback)(
             CMDBM_Connection *conn);
+    int (*CopyIn)(
+            CMDBM_Connection *conn,
+            const char *table,
+            CMUTIL_StringArray *columns,
+            CMUTIL_JsonArray *rows,
+            void *udata,
+            CMBool (*rowcb)(CMDBM_CopyRow*, uint32_t, void*));
+    int (*CopyOut)(
+            CMDBM_Connection *conn,
+            CMUTIL_String *query,
+            CMUTIL_JsonArray *binds,
+            CMDBM_CopyFormat format,
+            void *udata,
+            CMBool (*sink)(const char*, size_t, void*));
+    void (*SetFetchSize)(
+            CMDBM_Connection *conn,
+            uint32_t rows);
+    int (*ExecuteLob)(
+            CMDBM_Connection *conn,
+            CMUTIL_String *query,
+            CMUTIL_JsonArray *binds,
+            CMUTIL_JsonObject *outs,
+            CMDBM_LobSource **lobs);
+    CMBool (*Ping)(
+            CMDBM_Connection *conn);
+    void (*ThreadInit)(
+            CMDBM_Connection *conn);
+    void (*ThreadEnd)(
+            CMDBM_Connection *conn);
 };
 
 CMDBM_Connection *CMDBM_ConnectionCreate(
@@ -82,7 +134,8 @@ struct CMDBM_DatabaseEx {
             CMDBM_DatabaseEx *db,
             const char *id);
     CMDBM_Connection *(*GetConnection)(
-            CMDBM_DatabaseEx *db);
+            CMDBM_DatabaseEx *db,
+            long millisec);     // negative for pool configuration
     void (*ReleaseConnection)(
             CMDBM_DatabaseEx *db,
             CMDBM_Connection *conn);
@@ -90,6 +143,13 @@ struct CMDBM_DatabaseEx {
             CMDBM_DatabaseEx *db);
     void (*UnlockQueryItem)(
             CMDBM_DatabaseEx *db);
+    uint32_t (*GetFetchSize)(
+            CMDBM_DatabaseEx *db);
+    size_t (*GetResultMemory)(
+            CMDBM_DatabaseEx *db);
+    void (*GetPoolStats)(
+            CMDBM_DatabaseEx *db,
+            CMDBM_PoolStats *stats);
 };
 
 typedef struct CMDBM_ContextEx CMDBM_ContextEx;